@@ -1,51 +1,89 @@
+#include <algorithm>
 #include <iostream>
-#include <fstream>
 #include <chrono>
+#include <cstdlib>
+#include <string>
 #include <thread>
+#include "engine/engine.h"
 using namespace std;
 
-#define BOARD_SIZE 4
-int board[BOARD_SIZE][BOARD_SIZE];
-
-void createBoard();
-void placeBead();
-void printBoard();
-bool isEmpty(int row, int column);
-bool isValid(int row, int column);
-bool makeMove(int player, int srcRow, int srcCol, int desRow, int desCol);
-bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol);
-bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol);
-bool hasValidMoves(int player);
-int countBeads(int player);
-void saveGame(int currentPlayer);
-void loadGame(int &currentPlayer);
+const int DEFAULT_BOARD_SIZE = 4; // Other sizes: BEAD12 5, 6, 8 or 10
+template <int N>
+using BeadGame = bead::Game<N>; // Beads, rules and the player to move
+
+template <int N>
+int playGame();
+template <int N>
+void printBoard(const BeadGame<N> &game);
+template <int N>
+bool makeMove(BeadGame<N> &game, int srcRow, int srcCol, int desRow, int desCol);
+template <int N>
+void saveGame(const BeadGame<N> &game, int timeRemaining);
+template <int N>
+void loadGame(BeadGame<N> &game, int &timeRemaining);
+string sizedFile(const char *pattern, int boardSize);
 
 const int TIME_LIMIT = 30; // Time limit for each player's turn in seconds
+const char *const SAVE_FILE = "saved_game%d.bin"; // Saved game, see engine/save_format.h; %d is the board size
+const char *const JOURNAL_FILE = "saved_game%d.journal"; // Moves of the game in progress, kept in case of a crash
+const bead::Rules DIAGONAL_RULES{bead::DIAGONAL_DIRECTIONS}; // Jumps in this version are diagonal only
+
+// Each board size is its own instantiation of the game, with the bitboard
+// width and move tables of that size
+int main(int argc, char **argv)
+{
+    int boardSize = argc > 1 ? atoi(argv[1]) : DEFAULT_BOARD_SIZE;
+    switch (boardSize)
+    {
+    case 4:
+        return playGame<4>();
+    case 5:
+        return playGame<5>();
+    case 6:
+        return playGame<6>();
+    case 8:
+        return playGame<8>();
+    case 10:
+        return playGame<10>();
+    }
+    cout << "Unsupported board size " << boardSize << "; use 4, 5, 6, 8 or 10." << endl;
+    return 1;
+}
 
-int main()
+template <int N>
+int playGame()
 {
-    int currentPlayer = 1; // Player 1 starts
+    BeadGame<N> game(DIAGONAL_RULES); // Player 1 starts
+    int turnTime = TIME_LIMIT;        // Seconds allowed for the current turn; less when resuming a save
+    bead::Journal<N> journal;         // Records every move as it is played
+    string journalFile = sizedFile(JOURNAL_FILE, N);
     char option;
 
     cout << "Do you want to load a previous game? (y/n): ";
     cin >> option;
     if (option == 'y' || option == 'Y')
     {
-        loadGame(currentPlayer);
-        printBoard();
+        loadGame(game, turnTime);
+        printBoard(game);
     }
     else
     {
-        createBoard();
-        printBoard();
+        // Pick up the game a crash interrupted, if any
+        if (bead::Journal<N>::recover(journalFile, game) == bead::SAVE_OK)
+        {
+            cout << "Recovered an unfinished game." << endl;
+        }
+        printBoard(game);
     }
+    journal.start(journalFile, game);
 
     while (true)
     {
+        int currentPlayer = game.sideToMove();
         cout << "Player " << currentPlayer << "'s turn." << endl;
 
         // Check if the current player has any beads left
-        if (countBeads(currentPlayer) == 0)
+        if (game.position().count(currentPlayer) == 0)
         {
             cout << "Player " << currentPlayer << " has no beads left. Player "
                  << ((currentPlayer == 1) ? 2 : 1) << " wins!" << endl;
@@ -53,7 +91,7 @@ int main()
         }
 
         // Check if the player is blocked
-        if (!hasValidMoves(currentPlayer))
+        if (game.isBlocked())
         {
             cout << "Player " << currentPlayer << " is blocked. Player "
                  << ((currentPlayer == 1) ? 2 : 1) << " wins!" << endl;
@@ -74,276 +112,132 @@ int main()
                 cin >> option;
                 if (option == 'y' || option == 'Y')
                 {
-                    saveGame(currentPlayer);
+                    auto elapsed = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - start).count();
+                    saveGame(game, max(turnTime - int(elapsed), 0));
                 }
                 cout << "Player " << currentPlayer << " has quit the game." << endl;
+                journal.discard();
                 return 0;
             }
 
-            if (makeMove(currentPlayer, srcRow, srcCol, desRow, desCol))
+            // A successful move hands the turn to the other player
+            if (makeMove(game, srcRow, srcCol, desRow, desCol))
             {
-                printBoard();
-                break; 
+                journal.record(game);
+                printBoard(game);
+                turnTime = TIME_LIMIT;
+                break;
             }
 
-          
+
             auto end = chrono::steady_clock::now();
             auto elapsed = chrono::duration_cast<chrono::seconds>(end - start).count();
-            if (elapsed >= TIME_LIMIT)
+            if (elapsed >= turnTime)
             {
                 cout << "Time's up! Player " << currentPlayer << " has run out of time." << endl;
+                game.passTurn(); // Switch to the other player
+                journal.record(game);
+                turnTime = TIME_LIMIT;
                 break;
             }
         }
-
-        // Switch to the other player
-        currentPlayer = (currentPlayer == 1) ? 2 : 1;
     }
 
+    journal.discard(); // Nothing left to recover
     cout << "Game Over!" << endl;
     return 0;
 }
 
-void saveGame(int currentPlayer)
+// File name for one board size: pattern with its %d replaced by the size
+string sizedFile(const char *pattern, int boardSize)
 {
-    ofstream file("saved_game.txt");
-    if (!file)
-    {
-        cout << "Error saving the game!" << endl;
-        return;
-    }
+    string name = pattern;
+    return name.replace(name.find("%d"), 2, to_string(boardSize));
+}
 
-    file << currentPlayer << endl;
-    for (int i = 0; i < BOARD_SIZE; i++)
+// Save the game with the time left on the current turn
+template <int N>
+void saveGame(const BeadGame<N> &game, int timeRemaining)
+{
+    bead::SaveStatus status = bead::writeSaveFile(sizedFile(SAVE_FILE, N), game, timeRemaining * 1000);
+    if (status != bead::SAVE_OK)
     {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            file << board[i][j] << " ";
-        }
-        file << endl;
+        cout << "Error saving the game: " << bead::saveStatusText(status) << endl;
+        return;
     }
-
-    file.close();
     cout << "Game saved successfully!" << endl;
 }
 
-bool makeMove(int player, int srcRow, int srcCol, int desRow, int desCol)
+// Play a move for the side to move, explaining why an illegal one was refused
+template <int N>
+bool makeMove(BeadGame<N> &game, int srcRow, int srcCol, int desRow, int desCol)
 {
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+    if (!BeadGame<N>::isValid(srcRow, srcCol) || !BeadGame<N>::isValid(desRow, desCol))
     {
         cout << "Invalid move: Out of board bounds." << endl;
         return false;
     }
 
-    if (board[srcRow][srcCol] != player)
+    if (game.at(srcRow, srcCol) != game.sideToMove())
     {
         cout << "Invalid move: The selected source does not contain your bead." << endl;
         return false;
     }
 
-    if (!isEmpty(desRow, desCol))
+    if (!game.isEmpty(desRow, desCol))
     {
         cout << "Invalid move: The destination is not empty." << endl;
         return false;
     }
 
-    if (isMovable(player, srcRow, srcCol, desRow, desCol))
-    {
-        // Simple move
-        board[desRow][desCol] = board[srcRow][srcCol];
-        board[srcRow][srcCol] = 0;
-        return true;
-    }
-    else if (isEdible(player, srcRow, srcCol, desRow, desCol))
-    {
-        // Jump and eat opponent's bead
-        int midRow = (srcRow + desRow) / 2;
-        int midCol = (srcCol + desCol) / 2;
-
-        board[midRow][midCol] = 0; // Remove opponent's bead
-        board[desRow][desCol] = board[srcRow][srcCol];
-        board[srcRow][srcCol] = 0;
-
-        return true;
-    }
-    else
+    // A simple move, or a jump that eats the opponent's bead
+    if (!game.makeMove(srcRow, srcCol, desRow, desCol))
     {
         cout << "Invalid move: The move is neither simple nor a valid jump." << endl;
         return false;
     }
+    return true;
 }
 
-void loadGame(int &currentPlayer)
+// Load a saved game and the time left on its turn; a damaged file is
+// reported and a new game started instead
+template <int N>
+void loadGame(BeadGame<N> &game, int &timeRemaining)
 {
-    ifstream file("saved_game.txt");
-    if (!file)
+    int timeRemainingMs = 0;
+    bead::SaveStatus status = bead::readSaveFile(sizedFile(SAVE_FILE, N), game, timeRemainingMs);
+    if (status == bead::SAVE_NOT_FOUND)
     {
         cout << "No saved game found. Starting a new game!" << endl;
-        createBoard();
+        game.reset();
         return;
     }
-
-    file >> currentPlayer;
-    for (int i = 0; i < BOARD_SIZE; i++)
+    if (status != bead::SAVE_OK)
     {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            file >> board[i][j];
-        }
+        cout << "Could not load the saved game (" << bead::saveStatusText(status) << "). Starting a new game!" << endl;
+        game.reset();
+        return;
     }
-
-    file.close();
+    timeRemaining = min(max((timeRemainingMs + 999) / 1000, 1), TIME_LIMIT);
     cout << "Game loaded successfully!" << endl;
 }
 
-bool isEmpty(int row, int column)
-{
-    return board[row][column] == 0;
-}
-
-bool isValid(int row, int column)
-{
-    return (row >= 0 && column >= 0 && row < BOARD_SIZE && column < BOARD_SIZE);
-}
-
-bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol)
-{
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
-    {
-        return false;
-    }
-    if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
-    {
-        return false;
-    }
-    if (!isEmpty(desRow, desCol))
-    {
-        return false;
-    }
-    if (abs(srcRow - desRow) > 1 || abs(srcCol - desCol) > 1)
-    {
-        return false;
-    }
-    return true;
-}
-
-bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol)
+template <int N>
+void printBoard(const BeadGame<N> &game)
 {
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+    for (int i = 0; i < N; i++)
     {
-        return false;
-    }
-    if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
-    {
-        return false;
-    }
-    if (!isEmpty(desRow, desCol))
-    {
-        return false;
-    }
-
-    int midRow = (srcRow + desRow) / 2;
-    int midCol = (srcCol + desCol) / 2;
-
-    int opponent = (player == 1) ? 2 : 1;
-    if (board[midRow][midCol] == opponent &&
-        abs(srcRow - desRow) == 2 && abs(srcCol - desCol) == 2)
-    {
-        return true;
-    }
-    return false;
-}
-
-bool hasValidMoves(int player)
-{
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
+        for (int j = 0; j < N; j++)
         {
-            if (board[i][j] == player)
-            {
-                for (int di = -2; di <= 2; di++)
-                {
-                    for (int dj = -2; dj <= 2; dj++)
-                    {
-                        if (di == 0 && dj == 0)
-                            continue;
-                        int newRow = i + di;
-                        int newCol = j + dj;
-                        if (isMovable(player, i, j, newRow, newCol) ||
-                            isEdible(player, i, j, newRow, newCol))
-                        {
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
-}
-
-void createBoard()
-{
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            board[i][j] = 0;
-        }
-    }
-    placeBead();
-}
-
-void placeBead()
-{
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            if (i < BOARD_SIZE / 3)
-            {
-                board[i][j] = 1;
-            }
-            else if (i >= (BOARD_SIZE - BOARD_SIZE / 3))
-            {
-                board[i][j] = 2;
-            }
-        }
-    }
-}
-
-void printBoard()
-{
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            if (board[i][j] == 0)
+            if (game.at(i, j) == 0)
             {
                 cout << ". ";
             }
             else
             {
-                cout << board[i][j] << " ";
+                cout << game.at(i, j) << " ";
             }
         }
         cout << endl;
     }
 }
-
-int countBeads(int player)
-{
-    int count = 0;
-    for (int i = 0; i < BOARD_SIZE; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE; j++)
-        {
-            if (board[i][j] == player)
-            {
-                count++;
-            }
-        }
-    }
-    return count;
-}
\ No newline at end of file
@@ -1,230 +1,149 @@
 #include <SFML/Graphics.hpp>
-#include <cmath>
+#include <algorithm>
 #include <vector>
-#include <fstream>
 #include <chrono>
-#include <sstream>
 #include <iostream>
+#include "engine/engine.h"
+#include "board_view.h"
+#include "frame_scheduler.h"
+#include "hud.h"
 using namespace std;
 using namespace sf;
 
 
+const int GRID_SIZES[] = {4, 5, 6, 8, 10}; // Board sizes the menu offers
+const int DEFAULT_GRID_SIZE = 6;
+const int BOARD_SIZE = 600; // Board width in pixels, whatever the grid size
+const int WINDOW_HEIGHT = BOARD_SIZE + 200; // Increased height for the Exit button
+const int WINDOW_WIDTH = BOARD_SIZE;
+
+template <int N>
+constexpr int CELL_SIZE = BOARD_SIZE / N;
+
+// Rules, position and side to move (1 for Red, 2 for Blue) live in the headless engine
+template <int N>
+using BeadGame = bead::Game<N>;
+
 // Function prototypes
-bool isValid(int row, int col);
-bool isEmpty(int row, int col);
-int calculateDistance(int srcRow, int srcCol, int desRow, int desCol);
-bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol);
-bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol);
-bool hasValidMoves(int player);
-bool makeMove(int player, int srcRow, int srcCol, int desRow, int desCol);
-void saveBoard();
-void loadBoard();
-void switchPlayer();
+template <int N>
+void saveBoard(const BeadGame<N> &game, chrono::steady_clock::time_point turnStart);
+template <int N>
+void loadBoard(BeadGame<N> &game, chrono::steady_clock::time_point &turnStart);
+template <int N>
+void switchPlayer(BeadGame<N> &game);
 int getTimeRemaining();
-bool checkWinCondition(Text &winText);
+template <int N>
+bool checkWinCondition(const BeadGame<N> &game, CachedText &winText);
+template <int N>
 void playerVsComputer(RenderWindow &window, Font &font);
-bool computerMove();
+template <int N>
+bool playerVsPlayer(RenderWindow &window, Font &font, FrameScheduler &scheduler);
+template <int N>
+void computerMove(BeadGame<N> &game, const bead::SearchResult &result);
+template <int N>
+void resumeJournal(BeadGame<N> &game);
+bool playGame(int gridSize, bool vsComputer, RenderWindow &window, Font &font, FrameScheduler &scheduler);
+template <int N>
+bool playGame(bool vsComputer, RenderWindow &window, Font &font, FrameScheduler &scheduler);
+string variantFile(const char *pattern, int gridSize);
 void startGame();
 
-const int GRID_SIZE = 6;
-const int CELL_SIZE = 100;
-const int BOARD_SIZE = GRID_SIZE * CELL_SIZE;
-const int WINDOW_HEIGHT = BOARD_SIZE + 200; // Increased height for the Exit button
-const int WINDOW_WIDTH = BOARD_SIZE;
-
-int board[GRID_SIZE][GRID_SIZE] = {0};
-int currentPlayer = 1; // 1 for Red, 2 for Blue
 chrono::time_point<chrono::steady_clock> startTime;
 const int TURN_TIME_LIMIT = 30; // 30 seconds per turn
-
-int main()
-{
-    startGame();
-
-    return 0;
-}
-
-// Function to check valid position
-bool isValid(int row, int col)
-{
-    return row >= 0 && col >= 0 && row < GRID_SIZE && col < GRID_SIZE;
-}
-
-// Function to check if a cell is empty
-bool isEmpty(int row, int col)
-{
-    return board[row][col] == 0;
-}
-
-// Calculate distance between two points
-int calculateDistance(int srcRow, int srcCol, int desRow, int desCol)
+const int AI_THINK_TIME_MS = 2000; // Search budget for the computer, well inside the turn limit
+const int AI_HASH_MB = 16;         // Transposition table size for the computer
+const int AI_THREADS = 0;          // Search threads for the computer; 0 uses every core
+const int FRAME_RATE_CAP = 60;     // Most frames per second, reached only while the screen changes
+const char *const FONT_FILE = "arial.ttf";
+const char *const TABLEBASE_FILE = "bead%d.tb"; // Endgame tables from tools/tbgen, %d being the grid size; optional
+const char *const BOOK_FILE = "bead%d.book";    // Opening moves from tools/bookgen; optional
+const char *const SAVE_FILE = "board_save%d.bin"; // Saved game, see engine/save_format.h
+const char *const JOURNAL_FILE = "bead12-%d.journal"; // Moves of the game in progress, kept in case of a crash
+
+// Computer player and game files for one grid size, set up the first time
+// a game of that size starts
+template <int N>
+struct Variant
 {
-    if ((pow(srcRow - desRow, 2) + pow(srcCol - desCol, 2)) == 5)
+    bead::Searcher<N> searcher{AI_HASH_MB}; // Computer player's search engine
+    bead::Tablebase<N> tablebase;           // Exact results for endgames with few beads
+    bead::OpeningBook<N> book;              // Self-play results for the first moves
+    bead::Journal<N> journal;               // Records every move as it is played
+    const string saveFile = variantFile(SAVE_FILE, N);
+    const string journalFile = variantFile(JOURNAL_FILE, N);
+
+    Variant()
     {
-        return 3; 
+        searcher.setThreads(AI_THREADS);
+        if (tablebase.open(variantFile(TABLEBASE_FILE, N)))
+        {
+            searcher.setTablebase(&tablebase);
+            cout << "Endgame tablebase loaded: up to " << tablebase.maxBeads() << " beads" << endl;
+        }
+        if (book.open(variantFile(BOOK_FILE, N)))
+        {
+            cout << "Opening book loaded: " << book.size() << " moves" << endl;
+        }
     }
+};
 
-    return sqrt(pow(srcRow - desRow, 2) + pow(srcCol - desCol, 2));
-}
-
-// Check if a bead can move
-bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol)
+template <int N>
+Variant<N> &variant()
 {
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
-        return false;
-    if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
-        return false;
-    if (!isEmpty(desRow, desCol))
-        return false;
-    if (calculateDistance(srcRow, srcCol, desRow, desCol) != 1)
-        return false;
-    return true;
+    static Variant<N> instance;
+    return instance;
 }
 
-bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol)
+int main()
 {
-    // Ensure source and destination are valid
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
-    {
-        return false;
-    }
-
-    // Ensure the source contains the player's bead
-    if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
-    {
-        return false;
-    }
-
-    // Ensure the destination is empty
-    if (!isEmpty(desRow, desCol))
-    {
-        return false;
-    }
-
-    // Calculate the midpoint between source and destination
-    int midRow = (srcRow + desRow) / 2;
-    int midCol = (srcCol + desCol) / 2;
-
-    if (!isValid(midRow, midCol))
-    {
-        return false;
-    }
-
-    int opponent = (player == 1) ? 2 : 1;
-    if (board[midRow][midCol] != opponent)
-    {
-        return false;
-    }
-    if (calculateDistance(srcRow, srcCol, desRow, desCol) == 2)
-    {
-        return true;
-    }
+    startGame();
 
-    return false;
+    return 0;
 }
 
-bool hasValidMoves(int player)
+// File name for one grid size: pattern with its %d replaced by the size
+string variantFile(const char *pattern, int gridSize)
 {
-    for (int i = 0; i < GRID_SIZE; i++)
-    {
-        for (int j = 0; j < GRID_SIZE; j++)
-        {
-            if (board[i][j] == player)
-            {
-                for (int di = -2; di <= 2; di++)
-                {
-                    for (int dj = -2; dj <= 2; dj++)
-                    {
-                        if (di == 0 && dj == 0)
-                            continue;
-                        int newRow = i + di;
-                        int newCol = j + dj;
-                        if (isEdible(player, i, j, newRow, newCol) || isMovable(player, i, j, newRow, newCol))
-                        {
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
+    string name = pattern;
+    return name.replace(name.find("%d"), 2, to_string(gridSize));
 }
 
-bool makeMove(int player, int srcRow, int srcCol, int desRow, int desCol)
+// Save game state: position, move history and the time left on this turn
+template <int N>
+void saveBoard(const BeadGame<N> &game, chrono::steady_clock::time_point turnStart)
 {
-    if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+    int elapsedMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - turnStart).count();
+    int timeRemainingMs = max(TURN_TIME_LIMIT * 1000 - elapsedMs, 0);
+    const string &saveFile = variant<N>().saveFile;
+    bead::SaveStatus status = bead::writeSaveFile(saveFile, game, timeRemainingMs);
+    if (status != bead::SAVE_OK)
     {
-        return false;
+        cerr << "Error: could not save " << saveFile << ": " << bead::saveStatusText(status) << endl;
     }
-
-    if (board[srcRow][srcCol] != player)
-    {
-        return false;
-    }
-
-    if (!isEmpty(desRow, desCol))
-    {
-        return false;
-    }
-
-    if (isMovable(player, srcRow, srcCol, desRow, desCol))
-    {
-        // Simple move
-        board[desRow][desCol] = board[srcRow][srcCol];
-        board[srcRow][srcCol] = 0;
-        return true;
-    }
-    else if (isEdible(player, srcRow, srcCol, desRow, desCol))
-    {
-        // Jump, eat opponent bead
-        int midRow = (srcRow + desRow) / 2;
-        int midCol = (srcCol + desCol) / 2;
-        board[midRow][midCol] = 0;
-        board[desRow][desCol] = board[srcRow][srcCol];
-        board[srcRow][srcCol] = 0;
-        return true;
-    }
-
-    return false;
 }
 
-// Save game state
-void saveBoard()
+// Load game state, resuming the turn clock where it was saved; a missing or
+// damaged file leaves the game as it is
+template <int N>
+void loadBoard(BeadGame<N> &game, chrono::steady_clock::time_point &turnStart)
 {
-    ofstream file("board_save.txt");
-    for (int i = 0; i < GRID_SIZE; ++i)
+    const string &saveFile = variant<N>().saveFile;
+    int timeRemainingMs = 0;
+    bead::SaveStatus status = bead::readSaveFile(saveFile, game, timeRemainingMs);
+    if (status != bead::SAVE_OK)
     {
-        for (int j = 0; j < GRID_SIZE; ++j)
-        {
-            file << board[i][j] << " ";
-        }
-        file << "\n";
-    }
-    file.close();
-}
-
-// Load game state
-void loadBoard()
-{
-    ifstream file("board_save.txt");
-    if (file.is_open())
-    {
-        for (int i = 0; i < GRID_SIZE; ++i)
-        {
-            for (int j = 0; j < GRID_SIZE; ++j)
-            {
-                file >> board[i][j];
-            }
-        }
-        file.close();
+        cerr << "Error: could not load " << saveFile << ": " << bead::saveStatusText(status) << endl;
+        return;
     }
+    timeRemainingMs = min(max(timeRemainingMs, 0), TURN_TIME_LIMIT * 1000);
+    turnStart = chrono::steady_clock::now() - chrono::milliseconds(TURN_TIME_LIMIT * 1000 - timeRemainingMs);
 }
 
 // Switch player and reset the timer
-void switchPlayer()
+template <int N>
+void switchPlayer(BeadGame<N> &game)
 {
-    currentPlayer = (currentPlayer == 1) ? 2 : 1;
+    game.passTurn();
     startTime = chrono::steady_clock::now();
 }
 
@@ -236,67 +155,47 @@ int getTimeRemaining()
     return TURN_TIME_LIMIT - elapsedTime;
 }
 
-bool checkWinCondition(Text &winText)
+template <int N>
+bool checkWinCondition(const BeadGame<N> &game, CachedText &winText)
 {
-    int player1Beads = 0, player2Beads = 0;
+    int winner = game.winner();
 
-    for (int i = 0; i < GRID_SIZE; i++)
+    if (winner == 2)
     {
-        for (int j = 0; j < GRID_SIZE; j++)
-        {
-            if (board[i][j] == 1)
-            {
-                player1Beads++;
-            }
-            else if (board[i][j] == 2)
-            {
-                player2Beads++;
-            }
-        }
+        winText.setString("Player 2 Wins! Congratulations!");
+        return true;
     }
 
-    if (player1Beads == 0)
+    if (winner == 1)
     {
-        winText.setString("Player 2 Wins! Congratulations!");
+        winText.setString("Player 1 Wins! Congratulations!");
         return true;
     }
 
-    if (player2Beads == 0)
+    // A player who cannot move on their turn loses
+    if (game.isBlocked())
     {
-        winText.setString("Player 1 Wins! Congratulations!");
+        int blocked = game.sideToMove();
+        winText.setString("Player " + to_string(3 - blocked) + " Wins!\nPlayer " + to_string(blocked) +
+                          " is blocked.");
         return true;
     }
 
     return false;
 }
 
+template <int N>
 void playerVsComputer(RenderWindow &window, Font &font)
 {
+    bead::Journal<N> &journal = variant<N>().journal;
+    bead::OpeningBook<N> &book = variant<N>().book;
 
-    // Initialize the board with default positions for Player 1 and Player 2
-    for (int i = 0; i < GRID_SIZE; i++)
-    {
-        for (int j = 0; j < GRID_SIZE; j++)
-        {
-            if (i < 2)
-            {
-                board[i][j] = 1; // Player 1's beads
-            }
-            else if (i >= GRID_SIZE - 2)
-            {
-                board[i][j] = 2; // Player 2's beads
-            }
-            else
-            {
-                board[i][j] = 0; // Empty cells
-            }
-        }
-    }
+    // Default positions for Player 1 and Player 2; Player 1 starts
+    BeadGame<N> game;
+    resumeJournal(game);
 
-    int currentPlayer = 1;          // Player 1 starts
     int timeLeft = TURN_TIME_LIMIT; // 30 seconds for each turn
     auto startTime = chrono::steady_clock::now();
-    string message = ""; // Message to display below the timer
 
     int srcRow = -1, srcCol = -1; // Track the selected source bead
 
@@ -318,9 +217,7 @@ void playerVsComputer(RenderWindow &window, Font &font)
     mainMenuButton.setPosition(350, BOARD_SIZE + 90); // Position next to the Exit button
     mainMenuButton.setFillColor(Color::Black);
 
-    Text timerText("", font, 30);
-    timerText.setPosition(350, BOARD_SIZE + 20); // Adjusted position next to Load button
-    timerText.setFillColor(Color::Black);
+    Hud hud(font, BOARD_SIZE); // Timer, turn, status and win text; laid out only when they change
 
     RectangleShape saveButtonBg(Vector2f(100, 50));
     saveButtonBg.setPosition(50, BOARD_SIZE + 20);
@@ -339,21 +236,23 @@ void playerVsComputer(RenderWindow &window, Font &font)
     mainMenuButtonBg.setFillColor(Color::Yellow);
 
     auto computerMoveStartTime = chrono::steady_clock::now(); // Track when the computer's turn starts
-
-    Text winText("", font, 40); // Winning message
-    winText.setPosition(50, BOARD_SIZE / 2 - 20);
-    winText.setFillColor(Color::Black);
+    bead::AsyncSearch<N> computer(variant<N>().searcher);      // Thinks on a background thread
+    BoardView<N> boardView(CELL_SIZE<N>);                       // Rebuilt only when the board changes
 
     bool gameWon = false;
     bool returnToMainMenu = false;
 
+    FrameScheduler scheduler(FRAME_RATE_CAP); // Sleep until input, a timer tick or the computer's move
+
     while (window.isOpen())
     {
+        scheduler.wait(window);
         Event event;
-        while (window.pollEvent(event))
+        while (scheduler.pollEvent(window, event))
         {
             if (event.type == Event::Closed)
             {
+                computer.cancel();
                 window.close();
                 exit(0);
             }
@@ -376,49 +275,43 @@ void playerVsComputer(RenderWindow &window, Font &font)
                     {
                         if (saveButton.getGlobalBounds().contains(x, y))
                         {
-                            saveBoard();
+                            saveBoard(game, startTime);
                         }
                         else if (loadButton.getGlobalBounds().contains(x, y))
                         {
-                            loadBoard();
+                            computer.cancel(); // The search was for the old position
+                            loadBoard(game, startTime);
                         }
                         else if (exitButtonBg.getGlobalBounds().contains(x, y))
                         {
+                            computer.cancel();
                             window.close(); // Exit the game
                         }
                         else if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
                         {
+                            computer.cancel();
+                            journal.discard(); // The game is abandoned
                             returnToMainMenu = true; // Return to the main menu
                         }
                     }
-                    else if (currentPlayer == 1 && !gameWon)
+                    else if (game.sideToMove() == 1 && !gameWon)
                     { // Player's turn
-                        int row = y / CELL_SIZE;
-                        int col = x / CELL_SIZE;
+                        int row = y / CELL_SIZE<N>;
+                        int col = x / CELL_SIZE<N>;
 
-                        if (isValid(row, col))
+                        if (game.isValid(row, col))
                         {
-                            if (srcRow == -1 && srcCol == -1 && !isEmpty(row, col) && board[row][col] == currentPlayer)
+                            if (srcRow == -1 && srcCol == -1 && game.at(row, col) == 1)
                             {
                                 srcRow = row;
                                 srcCol = col;
-                                possibleMoves.clear();
-                                for (int i = 0; i < GRID_SIZE; i++)
-                                {
-                                    for (int j = 0; j < GRID_SIZE; j++)
-                                    {
-                                        if (isMovable(currentPlayer, srcRow, srcCol, i, j) || isEdible(currentPlayer, srcRow, srcCol, i, j))
-                                        {
-                                            possibleMoves.push_back({i, j});
-                                        }
-                                    }
-                                }
+                                game.findPossibleMoves(srcRow, srcCol, possibleMoves);
                             }
                             else if (srcRow != -1 && srcCol != -1)
                             {
-                                if (makeMove(currentPlayer, srcRow, srcCol, row, col))
+                                if (game.makeMove(srcRow, srcCol, row, col))
                                 {
-                                    currentPlayer = 2;                                        // Switch to computer
+                                    // The move hands the turn to the computer
                                     startTime = chrono::steady_clock::now();             // Reset timer
                                     computerMoveStartTime = chrono::steady_clock::now(); // Reset computer move timer
                                 }
@@ -439,9 +332,10 @@ void playerVsComputer(RenderWindow &window, Font &font)
         }
 
         // Check if a player has won
-        if (!gameWon && checkWinCondition(winText))
+        if (!gameWon && checkWinCondition(game, hud.winText()))
         {
             gameWon = true;
+            journal.discard();
         }
 
         // Stop the timer and end the game if one player has no beads left
@@ -455,16 +349,21 @@ void playerVsComputer(RenderWindow &window, Font &font)
             mainMenuButtonBg.setPosition(190, BOARD_SIZE + 50);
             mainMenuButtonBg.setFillColor(Color::Yellow);
 
+            scheduler.requestRedraw();
             while (window.isOpen())
             {
-                window.clear(Color::White); // Clear the window with white color
-                window.draw(winText);
-                window.draw(mainMenuButtonBg);
-                window.draw(mainMenuButton);
-                window.display();
+                if (scheduler.beginFrame())
+                {
+                    window.clear(Color::White); // Clear the window with white color
+                    hud.drawWin(window);
+                    window.draw(mainMenuButtonBg);
+                    window.draw(mainMenuButton);
+                    window.display();
+                }
 
+                scheduler.wait(window);
                 Event event;
-                while (window.pollEvent(event))
+                while (scheduler.pollEvent(window, event))
                 {
                     if (event.type == Event::Closed)
                     {
@@ -481,14 +380,7 @@ void playerVsComputer(RenderWindow &window, Font &font)
                             if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
                             {
                                 // Reset the game state and return to the main menu
-                                for (int i = 0; i < GRID_SIZE; ++i)
-                                {
-                                    for (int j = 0; j < GRID_SIZE; ++j)
-                                    {
-                                        board[i][j] = 0;
-                                    }
-                                }
-                                currentPlayer = 1; // Reset to Player 1
+                                game.reset(); // Reset to Player 1
                                 return; // Exit the loop and show the main menu
                             }
                         }
@@ -501,72 +393,90 @@ void playerVsComputer(RenderWindow &window, Font &font)
         int timeRemaining = TURN_TIME_LIMIT - chrono::duration_cast<chrono::seconds>(
                                                   chrono::steady_clock::now() - startTime)
                                                   .count();
+        // Wake for the next tick of the turn timer, and redraw when it shows a new value
+        scheduler.wakeAt(startTime + chrono::seconds(TURN_TIME_LIMIT - timeRemaining + 1));
+        if (hud.setTimer(timeRemaining))
+        {
+            scheduler.requestRedraw();
+        }
+
         if (timeRemaining <= 0 && !gameWon)
         {
-            currentPlayer = (currentPlayer == 1) ? 2 : 1; // Switch player
+            computer.cancel(); // A computer that ran out of time forfeits its move
+            game.passTurn(); // Switch player
             startTime = chrono::steady_clock::now(); // Reset timer
-            if (currentPlayer == 2)
+            if (game.sideToMove() == 2)
             {
                 computerMoveStartTime = chrono::steady_clock::now(); // Reset computer move timer
             }
         }
 
-        // Computer's move
-        if (currentPlayer == 2 && !gameWon)
+        // Computer's move: think in the background while the window stays live
+        if (game.sideToMove() == 2 && !gameWon)
         {
+            bead::Move bookMove;
+            if (!computer.busy() && book.probe(game.position(), game.rules(), bookMove,
+                                               unsigned(chrono::steady_clock::now().time_since_epoch().count())))
+            {
+                // Known opening: reply at once without searching or running the clock
+                game.play(bookMove);
+                cout << "Computer: book move" << endl;
+                startTime = chrono::steady_clock::now(); // Reset timer
+                scheduler.requestRedraw();
+            }
+            else if (!computer.busy())
+            {
+                bead::SearchLimits limits;
+                limits.timeMs = AI_THINK_TIME_MS;
+                computer.start(game.position(), limits, game.rules(),
+                               [&scheduler](const bead::SearchResult &) { scheduler.notify(); });
+            }
+            // Wake when the computer's minimum second is up; once it is, the
+            // search's callback wakes the loop, and a wake time in the past
+            // would keep it from sleeping at all
+            auto computerMoveDue = computerMoveStartTime + chrono::seconds(1);
+            if (chrono::steady_clock::now() < computerMoveDue)
+            {
+                scheduler.wakeAt(computerMoveDue);
+            }
+
             auto elapsedTime = chrono::duration_cast<chrono::seconds>(
                                    chrono::steady_clock::now() - computerMoveStartTime)
                                    .count();
-            if (elapsedTime >= 1)
-            { 
-                if (computerMove())
+            if (elapsedTime >= 1 && computer.ready())
+            {
+                bool current = computer.key() == game.position().key();
+                bead::SearchResult result = computer.get();
+                if (current)
                 {
-                    currentPlayer = 1;                            // Switch back to player
+                    computerMove(game, result);
+                    // The move switches back to the player
                     startTime = chrono::steady_clock::now(); // Reset timer
+                    scheduler.requestRedraw();
                 }
             }
         }
 
-        window.clear(Color::White);
+        journal.record(game); // Moves and passes made this time round
 
-        // Draw grid and beads
-        for (int i = 0; i < GRID_SIZE; i++)
+        // Update both lines ("|" rather than "||"), redrawing if either changed
+        if (hud.setTurn(game.sideToMove()) | hud.setStatus(computer.busy() ? "Computer is thinking..." : ""))
         {
-            for (int j = 0; j < GRID_SIZE; j++)
-            {
-                RectangleShape cell(Vector2f(CELL_SIZE, CELL_SIZE));
-                cell.setPosition(j * CELL_SIZE, i * CELL_SIZE);
-                cell.setFillColor(Color::White);
-                cell.setOutlineThickness(1);
-                cell.setOutlineColor(Color::Black);
-                window.draw(cell);
-
-                if (board[i][j] == 1)
-                {
-                    CircleShape bead(CELL_SIZE / 3);
-                    bead.setFillColor(Color::Red);
-                    bead.setPosition(j * CELL_SIZE + CELL_SIZE / 6, i * CELL_SIZE + CELL_SIZE / 6);
-                    window.draw(bead);
-                }
-                else if (board[i][j] == 2)
-                {
-                    CircleShape bead(CELL_SIZE / 3);
-                    bead.setFillColor(Color::Blue);
-                    bead.setPosition(j * CELL_SIZE + CELL_SIZE / 6, i * CELL_SIZE + CELL_SIZE / 6);
-                    window.draw(bead);
-                }
-            }
+            scheduler.requestRedraw();
         }
 
-        // Highlight valid moves
-        for (auto &move : possibleMoves)
+        // Nothing on screen changed since the last frame
+        if (!scheduler.beginFrame())
         {
-            RectangleShape cell(Vector2f(CELL_SIZE, CELL_SIZE));
-            cell.setPosition(move.second * CELL_SIZE, move.first * CELL_SIZE);
-            cell.setFillColor(Color(0, 255, 0, 128));
-            window.draw(cell);
+            continue;
         }
 
+        window.clear(Color::White);
+
+        // Draw grid, beads and highlighted valid moves
+        boardView.update(game.position(), possibleMoves);
+        window.draw(boardView);
+
         // Draw buttons and timer
         window.draw(saveButtonBg);
         window.draw(loadButtonBg);
@@ -577,16 +487,13 @@ void playerVsComputer(RenderWindow &window, Font &font)
         window.draw(exitButton);
         window.draw(mainMenuButton);
 
-        stringstream ss;
-        ss << "Time: " << timeRemaining << "s";
-        timerText.setString(ss.str());
-        window.draw(timerText);
+        hud.drawPanel(window);
 
         // Draw win message if game is won
         if (gameWon)
         {
             window.clear(Color::White); // Clear the window with white color
-            window.draw(winText); // Only display the win message
+            hud.drawWin(window); // Only display the win message
             window.display();
             continue; // Skip the rest of the loop
         }
@@ -595,69 +502,48 @@ void playerVsComputer(RenderWindow &window, Font &font)
     }
 }
 
-bool computerMove()
+// Play the move the computer's search chose
+template <int N>
+void computerMove(BeadGame<N> &game, const bead::SearchResult &result)
 {
-    vector<tuple<int, int, int, int>> captureMoves; // Store capturing moves
-    vector<pair<int, int>> possibleMoves;           // Store simple moves
-
-    for (int srcRow = 0; srcRow < GRID_SIZE; ++srcRow)
+    if (!result.hasMove)
     {
-        for (int srcCol = 0; srcCol < GRID_SIZE; ++srcCol)
-        {
-            if (board[srcRow][srcCol] == 2)
-            { // Computer's beads
-                for (int desRow = 0; desRow < GRID_SIZE; ++desRow)
-                {
-                    for (int desCol = 0; desCol < GRID_SIZE; ++desCol)
-                    {
-                        if (isEdible(2, srcRow, srcCol, desRow, desCol))
-                        {
-                            // Store capturing moves with source and destination
-                            captureMoves.emplace_back(srcRow, srcCol, desRow, desCol);
-                        }
-                        else if (isMovable(2, srcRow, srcCol, desRow, desCol))
-                        {
-                            // Store simple moves
-                            possibleMoves.emplace_back(srcRow, srcCol);
-                        }
-                    }
-                }
-            }
-        }
+        game.passTurn(); // No valid moves
+        return;
     }
+    game.play(result.best);
 
-    // Prioritize capturing moves
-    if (!captureMoves.empty())
-    {
-        auto [srcRow, srcCol, desRow, desCol] = captureMoves[rand() % captureMoves.size()];
-        return makeMove(2, srcRow, srcCol, desRow, desCol);
-    }
+    cout << "Computer: depth " << result.depth << ", nodes " << result.nodes
+         << ", " << result.nodesPerSecond() << " nodes/s, hash hits "
+         << int(result.tt.hitRate() * 100) << "%" << endl;
+}
 
-    // If no capturing moves, perform a simple move
-    if (!possibleMoves.empty())
+// Pick up the game a crash interrupted, if any, and journal the game from here
+template <int N>
+void resumeJournal(BeadGame<N> &game)
+{
+    Variant<N> &files = variant<N>();
+    int replayed = 0;
+    if (bead::Journal<N>::recover(files.journalFile, game, &replayed) == bead::SAVE_OK)
     {
-        auto [srcRow, srcCol] = possibleMoves[rand() % possibleMoves.size()];
-        for (int desRow = 0; desRow < GRID_SIZE; ++desRow)
-        {
-            for (int desCol = 0; desCol < GRID_SIZE; ++desCol)
-            {
-                if (isMovable(2, srcRow, srcCol, desRow, desCol))
-                {
-                    return makeMove(2, srcRow, srcCol, desRow, desCol);
-                }
-            }
-        }
+        cout << "Recovered an unfinished game: " << game.history().size() << " moves, "
+             << replayed << " from the journal" << endl;
     }
-
-    return false; // No valid moves
+    files.journal.start(files.journalFile, game);
 }
 
 void startGame()
 {
-    RenderWindow window(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "6x6 Bead Grid");
+    RenderWindow window(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Bead Grid");
 
+    // Load the font once, with its glyphs for every text size the game draws
     Font font;
-    font.loadFromFile("arial.ttf");
+    if (!loadFont(font, FONT_FILE, {24, 30, 40}))
+    {
+        cerr << "Error: could not load the font " << FONT_FILE << endl;
+        window.close();
+        exit(1);
+    }
 
     // Option buttons
     Text pvpButton("Player vs Player", font, 30);
@@ -676,13 +562,26 @@ void startGame()
     pvcButtonBg.setPosition(90, BOARD_SIZE / 2 + 5);
     pvcButtonBg.setFillColor(Color::Cyan);
 
+    // Board size, stepping through GRID_SIZES on each click
+    int gridSize = DEFAULT_GRID_SIZE;
+    Text sizeButton("", font, 30);
+    sizeButton.setPosition(100, BOARD_SIZE / 2 + 70);
+    sizeButton.setFillColor(Color::Black);
+
+    RectangleShape sizeButtonBg(Vector2f(300, 50));
+    sizeButtonBg.setPosition(90, BOARD_SIZE / 2 + 65);
+    sizeButtonBg.setFillColor(Color::Yellow);
+
     bool gameStarted = false;
     bool isPlayerVsComputer = false;
 
+    FrameScheduler scheduler(FRAME_RATE_CAP); // The menu only redraws on input
+
     while (window.isOpen())
     {
+        scheduler.wait(window);
         Event event;
-        while (window.pollEvent(event))
+        while (scheduler.pollEvent(window, event))
         {
             if (event.type == Event::Closed)
                 window.close();
@@ -703,288 +602,307 @@ void startGame()
                         gameStarted = true; // Start Player vs Computer game
                         isPlayerVsComputer = true;
                     }
+                    else if (sizeButtonBg.getGlobalBounds().contains(x, y))
+                    {
+                        const int *next = find(begin(GRID_SIZES), end(GRID_SIZES), gridSize) + 1;
+                        gridSize = next == end(GRID_SIZES) ? GRID_SIZES[0] : *next;
+                        scheduler.requestRedraw();
+                    }
                 }
             }
         }
 
+        // Nothing on the menu changed since the last frame
+        if (!gameStarted && !scheduler.beginFrame())
+        {
+            continue;
+        }
+
         window.clear(Color::White);
 
         if (!gameStarted)
         {
             // Draw option buttons
+            sizeButton.setString("Board: " + to_string(gridSize) + "x" + to_string(gridSize));
             window.draw(pvpButtonBg);
             window.draw(pvcButtonBg);
+            window.draw(sizeButtonBg);
             window.draw(pvpButton);
             window.draw(pvcButton);
+            window.draw(sizeButton);
         }
         else
         {
-            if (isPlayerVsComputer)
+            // Start the chosen game on the chosen board size
+            if (!playGame(gridSize, isPlayerVsComputer, window, font, scheduler))
             {
-                // Start Player vs Computer game
-                playerVsComputer(window, font);
-                gameStarted = false; // Reset to show the menu after the game ends or "Main Menu" is clicked
+                return;
             }
-            else
-            {
-                // Initialize beads
-                for (int i = 0; i < 2; i++)
-                    for (int j = 0; j < GRID_SIZE; j++)
-                        board[i][j] = 1; // Red beads for Player 1
+            gameStarted = false; // Reset to show the menu after the game ends or "Main Menu" is clicked
+            scheduler.requestRedraw();
+        }
 
-                for (int i = 4; i < GRID_SIZE; i++)
-                    for (int j = 0; j < GRID_SIZE; j++)
-                        board[i][j] = 2; // Blue beads for Player 2
+        window.display();
+    }
+}
 
-                Text saveButton(" Save", font, 30);
-                saveButton.setPosition(50, BOARD_SIZE + 20);
-                saveButton.setFillColor(Color::Black);
+// Run a game on one of GRID_SIZES. Each size is a separate instantiation
+// of the game and engine, with its own bitboard width and move tables.
+bool playGame(int gridSize, bool vsComputer, RenderWindow &window, Font &font, FrameScheduler &scheduler)
+{
+    switch (gridSize)
+    {
+    case 4:
+        return playGame<4>(vsComputer, window, font, scheduler);
+    case 5:
+        return playGame<5>(vsComputer, window, font, scheduler);
+    case 8:
+        return playGame<8>(vsComputer, window, font, scheduler);
+    case 10:
+        return playGame<10>(vsComputer, window, font, scheduler);
+    default:
+        return playGame<6>(vsComputer, window, font, scheduler);
+    }
+}
 
-                Text loadButton(" Load", font, 30);
-                loadButton.setPosition(200, BOARD_SIZE + 20);
-                loadButton.setFillColor(Color::Black);
+template <int N>
+bool playGame(bool vsComputer, RenderWindow &window, Font &font, FrameScheduler &scheduler)
+{
+    if (!vsComputer)
+    {
+        return playerVsPlayer<N>(window, font, scheduler);
+    }
+    playerVsComputer<N>(window, font);
+    return true;
+}
 
-                Text exitButton(" Exit", font, 30);
-                exitButton.setPosition(200, BOARD_SIZE + 90); // Position below the Load button
-                exitButton.setFillColor(Color::Black);
+// Player vs Player on an N x N board; returns false when the players chose
+// to leave the game rather than go back to the main menu
+template <int N>
+bool playerVsPlayer(RenderWindow &window, Font &font, FrameScheduler &scheduler)
+{
+    bead::Journal<N> &journal = variant<N>().journal;
 
-                Text mainMenuButton("Main Menu", font, 30);
-                mainMenuButton.setPosition(350, BOARD_SIZE + 90); // Position next to the Exit button
-                mainMenuButton.setFillColor(Color::Black);
+    // Red beads for Player 1, blue beads for Player 2; Player 1 starts
+    BeadGame<N> game;
+    resumeJournal(game);
 
-                Text timerText("", font, 30);
-                timerText.setPosition(350, BOARD_SIZE + 20); // Adjusted position next to Load button
-                timerText.setFillColor(Color::Black);
+    Text saveButton(" Save", font, 30);
+    saveButton.setPosition(50, BOARD_SIZE + 20);
+    saveButton.setFillColor(Color::Black);
 
-                RectangleShape saveButtonBg(Vector2f(100, 50));
-                saveButtonBg.setPosition(50, BOARD_SIZE + 20);
-                saveButtonBg.setFillColor(Color::Cyan);
+    Text loadButton(" Load", font, 30);
+    loadButton.setPosition(200, BOARD_SIZE + 20);
+    loadButton.setFillColor(Color::Black);
 
-                RectangleShape loadButtonBg(Vector2f(100, 50));
-                loadButtonBg.setPosition(200, BOARD_SIZE + 20);
-                loadButtonBg.setFillColor(Color::Cyan);
+    Text exitButton(" Exit", font, 30);
+    exitButton.setPosition(200, BOARD_SIZE + 90); // Position below the Load button
+    exitButton.setFillColor(Color::Black);
 
-                RectangleShape exitButtonBg(Vector2f(100, 50));
-                exitButtonBg.setPosition(200, BOARD_SIZE + 90); // Position below the Load button
-                exitButtonBg.setFillColor(Color::Red);
+    Text mainMenuButton("Main Menu", font, 30);
+    mainMenuButton.setPosition(350, BOARD_SIZE + 90); // Position next to the Exit button
+    mainMenuButton.setFillColor(Color::Black);
 
-                RectangleShape mainMenuButtonBg(Vector2f(150, 50));
-                mainMenuButtonBg.setPosition(350, BOARD_SIZE + 90);
-                mainMenuButtonBg.setFillColor(Color::Yellow);
+    Hud hud(font, BOARD_SIZE); // Timer, turn and win text; laid out only when they change
 
-                Text winText("", font, 40);
-                winText.setPosition(50, BOARD_SIZE / 2 - 20);
-                winText.setFillColor(Color::Black);
+    RectangleShape saveButtonBg(Vector2f(100, 50));
+    saveButtonBg.setPosition(50, BOARD_SIZE + 20);
+    saveButtonBg.setFillColor(Color::Cyan);
 
-                startTime = chrono::steady_clock::now();
+    RectangleShape loadButtonBg(Vector2f(100, 50));
+    loadButtonBg.setPosition(200, BOARD_SIZE + 20);
+    loadButtonBg.setFillColor(Color::Cyan);
 
-                int selectedRow = -1, selectedCol = -1;
-                vector<pair<int, int>> possibleMoves;
+    RectangleShape exitButtonBg(Vector2f(100, 50));
+    exitButtonBg.setPosition(200, BOARD_SIZE + 90); // Position below the Load button
+    exitButtonBg.setFillColor(Color::Red);
+
+    RectangleShape mainMenuButtonBg(Vector2f(150, 50));
+    mainMenuButtonBg.setPosition(350, BOARD_SIZE + 90);
+    mainMenuButtonBg.setFillColor(Color::Yellow);
 
-                bool gameWon = false;
-                bool returnToMainMenu = false;
+    startTime = chrono::steady_clock::now();
 
-                while (window.isOpen())
+    int selectedRow = -1, selectedCol = -1;
+    vector<pair<int, int>> possibleMoves;
+    BoardView<N> boardView(CELL_SIZE<N>); // Rebuilt only when the board changes
+
+    bool gameWon = false;
+    bool returnToMainMenu = false;
+
+    while (window.isOpen())
+    {
+        scheduler.wait(window);
+        Event event;
+        while (scheduler.pollEvent(window, event))
+        {
+            if (event.type == Event::Closed)
+                window.close();
+            else if (!gameWon && event.type == Event::MouseButtonPressed)
+            {
+                if (event.mouseButton.button == Mouse::Left)
                 {
-                    Event event;
-                    while (window.pollEvent(event))
+                    int x = event.mouseButton.x;
+                    int y = event.mouseButton.y;
+
+                    if (y > BOARD_SIZE)
                     {
-                        if (event.type == Event::Closed)
-                            window.close();
-                        else if (!gameWon && event.type == Event::MouseButtonPressed)
+                        if (saveButton.getGlobalBounds().contains(x, y))
                         {
-                            if (event.mouseButton.button == Mouse::Left)
-                            {
-                                int x = event.mouseButton.x;
-                                int y = event.mouseButton.y;
+                            saveBoard(game, startTime);
+                        }
+                        else if (loadButton.getGlobalBounds().contains(x, y))
+                        {
+                            loadBoard(game, startTime);
+                        }
+                        else if (exitButtonBg.getGlobalBounds().contains(x, y))
+                        {
+                            window.close(); // Exit the game
+                        }
+                        else if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
+                        {
+                            journal.discard(); // The game is abandoned
+                            returnToMainMenu = true; // Return to the main menu
+                        }
+                    }
+                    else
+                    {
+                        int row = y / CELL_SIZE<N>;
+                        int col = x / CELL_SIZE<N>;
 
-                                if (y > BOARD_SIZE)
-                                {
-                                    if (saveButton.getGlobalBounds().contains(x, y))
-                                    {
-                                        saveBoard();
-                                    }
-                                    else if (loadButton.getGlobalBounds().contains(x, y))
-                                    {
-                                        loadBoard();
-                                    }
-                                    else if (exitButtonBg.getGlobalBounds().contains(x, y))
-                                    {
-                                        window.close(); // Exit the game
-                                    }
-                                    else if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
-                                    {
-                                        returnToMainMenu = true; // Return to the main menu
-                                    }
-                                }
-                                else
+                        if (game.isValid(row, col))
+                        {
+                            if (selectedRow == -1 && selectedCol == -1 && game.at(row, col) == game.sideToMove())
+                            {
+                                selectedRow = row;
+                                selectedCol = col;
+                                game.findPossibleMoves(selectedRow, selectedCol, possibleMoves);
+                            }
+                            else if (selectedRow != -1 && selectedCol != -1)
+                            {
+                                bool moved = game.makeMove(selectedRow, selectedCol, row, col);
+                                if (moved)
                                 {
-                                    int row = y / CELL_SIZE;
-                                    int col = x / CELL_SIZE;
-
-                                    if (isValid(row, col))
-                                    {
-                                        if (selectedRow == -1 && selectedCol == -1 && !isEmpty(row, col) && board[row][col] == currentPlayer)
-                                        {
-                                            selectedRow = row;
-                                            selectedCol = col;
-                                            possibleMoves.clear();
-                                            for (int i = 0; i < GRID_SIZE; i++)
-                                                for (int j = 0; j < GRID_SIZE; j++)
-                                                    if (isMovable(currentPlayer, selectedRow, selectedCol, i, j) || isEdible(currentPlayer, selectedRow, selectedCol, i, j))
-                                                        possibleMoves.push_back({i, j});
-                                        }
-                                        else if (selectedRow != -1 && selectedCol != -1)
-                                        {
-                                            bool moved = makeMove(currentPlayer, selectedRow, selectedCol, row, col);
-                                            if (moved)
-                                            {
-                                                switchPlayer();
-                                            }
-                                            selectedRow = -1;
-                                            selectedCol = -1;
-                                            possibleMoves.clear();
-                                        }
-                                    }
+                                    startTime = chrono::steady_clock::now(); // The move already switched players
                                 }
+                                selectedRow = -1;
+                                selectedCol = -1;
+                                possibleMoves.clear();
                             }
                         }
                     }
+                }
+            }
+        }
 
-                    // Return to the main menu if the button is clicked
-                    if (returnToMainMenu)
-                    {
-                        gameStarted = false; // Reset to show the menu
-                        break;
-                    }
+        // Return to the main menu if the button is clicked
+        if (returnToMainMenu)
+        {
+            return true;
+        }
 
-                    // Check if time expired
-                    if (!gameWon)
-                    {
-                        int timeRemaining = getTimeRemaining();
-                        if (timeRemaining <= 0)
-                        {
-                            switchPlayer();
-                        }
+        // Check if time expired
+        if (!gameWon)
+        {
+            int timeRemaining = getTimeRemaining();
+            if (timeRemaining <= 0)
+            {
+                switchPlayer(game);
+            }
 
-                        // Check if a player has won
-                        if (checkWinCondition(winText))
-                        {
-                            gameWon = true;
-                        }
+            // Wake for the next tick of the turn timer, and redraw when it shows a new value
+            scheduler.wakeAt(startTime + chrono::seconds(TURN_TIME_LIMIT - timeRemaining + 1));
+            // Update both lines ("|" rather than "||"), redrawing if either changed
+            if (hud.setTimer(timeRemaining) | hud.setTurn(game.sideToMove()))
+            {
+                scheduler.requestRedraw();
+            }
 
-                        // Update timer display
-                        stringstream ss;
-                        ss << "Time: " << timeRemaining << "s";
-                        timerText.setString(ss.str());
-                    }
+            journal.record(game); // Moves and passes made this time round
 
-                    window.clear(Color::White);
+            // Check if a player has won
+            if (checkWinCondition(game, hud.winText()))
+            {
+                gameWon = true;
+                journal.discard();
+            }
+        }
 
-                    // Draw grid
-                    for (int i = 0; i <= GRID_SIZE; i++)
-                    {
-                        Vertex horizontalLine[] = {
-                            Vertex(Vector2f(0, i * CELL_SIZE), Color::Black),
-                            Vertex(Vector2f(BOARD_SIZE, i * CELL_SIZE), Color::Black)};
-                        window.draw(horizontalLine, 2, Lines);
-
-                        Vertex verticalLine[] = {
-                            Vertex(Vector2f(i * CELL_SIZE, 0), Color::Black),
-                            Vertex(Vector2f(i * CELL_SIZE, BOARD_SIZE), Color::Black)};
-                        window.draw(verticalLine, 2, Lines);
-                    }
+        // Nothing on screen changed since the last frame
+        if (!scheduler.beginFrame())
+        {
+            continue;
+        }
 
-                    // Draw beads
-                    for (int i = 0; i < GRID_SIZE; i++)
-                        for (int j = 0; j < GRID_SIZE; j++)
-                            if (board[i][j] != 0)
-                            {
-                                CircleShape bead(CELL_SIZE / 3);
-                                bead.setFillColor(board[i][j] == 1 ? Color::Red : Color::Blue);
-                                bead.setPosition(j * CELL_SIZE + CELL_SIZE / 6, i * CELL_SIZE + CELL_SIZE / 6);
-                                window.draw(bead);
-                            }
+        window.clear(Color::White);
 
-                    // Highlight valid moves
-                    for (auto &move : possibleMoves)
-                    {
-                        RectangleShape cell(Vector2f(CELL_SIZE, CELL_SIZE));
-                        cell.setPosition(move.second * CELL_SIZE, move.first * CELL_SIZE);
-                        cell.setFillColor(Color(0, 255, 0, 128));
-                        window.draw(cell);
-                    }
+        // Draw grid, beads and highlighted valid moves
+        boardView.update(game.position(), possibleMoves);
+        window.draw(boardView);
+
+        // Draw buttons and timer
+        window.draw(saveButtonBg);
+        window.draw(loadButtonBg);
+        window.draw(exitButtonBg);
+        window.draw(mainMenuButtonBg);
+        window.draw(saveButton);
+        window.draw(loadButton);
+        window.draw(exitButton);
+        window.draw(mainMenuButton);
+        hud.drawPanel(window); // Timer is next to the Load button
 
-                    // Draw buttons and timer
-                    window.draw(saveButtonBg);
-                    window.draw(loadButtonBg);
-                    window.draw(exitButtonBg);
+        // Draw win message if game is won
+        if (gameWon)
+        {
+            Text mainMenuButton("Exit", font, 30);
+            mainMenuButton.setPosition(200, BOARD_SIZE + 50);
+            mainMenuButton.setFillColor(Color::Black);
+
+            RectangleShape mainMenuButtonBg(Vector2f(150, 50));
+            mainMenuButtonBg.setPosition(190, BOARD_SIZE + 50);
+            mainMenuButtonBg.setFillColor(Color::Red);
+
+            scheduler.requestRedraw();
+            while (window.isOpen())
+            {
+                if (scheduler.beginFrame())
+                {
+                    window.clear(Color::White); // Clear the window with white color
+                    hud.drawWin(window); // Only display the win message
                     window.draw(mainMenuButtonBg);
-                    window.draw(saveButton);
-                    window.draw(loadButton);
-                    window.draw(exitButton);
                     window.draw(mainMenuButton);
-                    window.draw(timerText); // Timer is now next to Load button
+                    window.display();
+                }
 
-                    // Draw win message if game is won
-                    if (gameWon)
+                scheduler.wait(window);
+                Event event;
+                while (scheduler.pollEvent(window, event))
+                {
+                    if (event.type == Event::Closed)
                     {
-                        Text mainMenuButton("Exit", font, 30);
-                        mainMenuButton.setPosition(200, BOARD_SIZE + 50);
-                        mainMenuButton.setFillColor(Color::Black);
-
-                        RectangleShape mainMenuButtonBg(Vector2f(150, 50));
-                        mainMenuButtonBg.setPosition(190, BOARD_SIZE + 50);
-                        mainMenuButtonBg.setFillColor(Color::Red);
-
-                        while (window.isOpen())
+                        window.close();
+                        exit(0);
+                    }
+                    else if (event.type == Event::MouseButtonPressed)
+                    {
+                        if (event.mouseButton.button == Mouse::Left)
                         {
-                            window.clear(Color::White); // Clear the window with white color
-                            window.draw(winText); // Only display the win message
-                            window.draw(mainMenuButtonBg);
-                            window.draw(mainMenuButton);
-                            window.display();
-
-                            Event event;
-                            while (window.pollEvent(event))
+                            int x = event.mouseButton.x;
+                            int y = event.mouseButton.y;
+
+                            if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
                             {
-                                if (event.type == Event::Closed)
-                                {
-                                    window.close();
-                                    exit(0);
-                                }
-                                else if (event.type == Event::MouseButtonPressed)
-                                {
-                                    if (event.mouseButton.button == Mouse::Left)
-                                    {
-                                        int x = event.mouseButton.x;
-                                        int y = event.mouseButton.y;
-
-                                        if (mainMenuButtonBg.getGlobalBounds().contains(x, y))
-                                        {
-                                            // Reset the game state and return to the main menu
-                                            for (int i = 0; i < GRID_SIZE; ++i)
-                                            {
-                                                for (int j = 0; j < GRID_SIZE; ++j)
-                                                {
-                                                    board[i][j] = 0;
-                                                }
-                                            }
-                                            currentPlayer = 1; // Reset to Player 1
-                                            return; // Exit the loop and show the main menu
-                                        }
-                                    }
-                                }
+                                // Reset the game state and return to the main menu
+                                game.reset(); // Reset to Player 1
+                                return false; // Leave the game
                             }
                         }
                     }
-
-                    window.display();
                 }
             }
         }
 
         window.display();
     }
+    return true;
 }
-
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "engine/position.h"
+
+// Retained-mode drawing of the board: grid lines in one vertex array built
+// once, beads and move highlights in a second one rebuilt only when the
+// beads or the highlighted cells change. Drawing a frame is two draw
+// calls however many beads are on the board.
+template <int N>
+class BoardView : public sf::Drawable
+{
+public:
+    static const int BEAD_POINTS = 30; // same outline as a default sf::CircleShape
+
+    explicit BoardView(int cellSize)
+        : cellSize(cellSize), grid(sf::Lines), pieces(sf::Triangles)
+    {
+        float size = float(N * cellSize);
+        for (int i = 0; i <= N; i++)
+        {
+            float offset = float(i * cellSize);
+            grid.append(sf::Vertex(sf::Vector2f(0, offset), sf::Color::Black));
+            grid.append(sf::Vertex(sf::Vector2f(size, offset), sf::Color::Black));
+            grid.append(sf::Vertex(sf::Vector2f(offset, 0), sf::Color::Black));
+            grid.append(sf::Vertex(sf::Vector2f(offset, size), sf::Color::Black));
+        }
+    }
+
+    // Bring the view up to date; cheap when nothing changed
+    void update(const bead::Position<N> &position, const std::vector<std::pair<int, int>> &highlights)
+    {
+        const auto &board = position.bitboard();
+        if (built && board.beads[0] == shown[0] && board.beads[1] == shown[1] && highlights == shownHighlights)
+            return;
+
+        shown[0] = board.beads[0];
+        shown[1] = board.beads[1];
+        shownHighlights = highlights;
+        built = true;
+
+        pieces.clear();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                int player = board.at(i, j);
+                if (player != 0)
+                    addBead(i, j, player == 1 ? sf::Color::Red : sf::Color::Blue);
+            }
+        }
+        for (const auto &cell : highlights)
+            addCell(cell.first, cell.second, sf::Color(0, 255, 0, 128));
+    }
+
+    // Force a rebuild on the next update
+    void invalidate()
+    {
+        built = false;
+    }
+
+protected:
+    void draw(sf::RenderTarget &target, sf::RenderStates states) const override
+    {
+        target.draw(grid, states);
+        target.draw(pieces, states);
+    }
+
+private:
+    int cellSize;
+    sf::VertexArray grid;
+    sf::VertexArray pieces;
+
+    bool built = false;
+    typename bead::BitBoard<N>::Mask shown[2] = {0, 0};
+    std::vector<std::pair<int, int>> shownHighlights;
+
+    // A bead of radius cellSize / 3 centred in its cell, as a triangle fan
+    void addBead(int row, int col, sf::Color color)
+    {
+        const float pi = 3.14159265f;
+        float radius = float(cellSize / 3);
+        sf::Vector2f centre(col * cellSize + cellSize / 6 + radius, row * cellSize + cellSize / 6 + radius);
+        for (int k = 0; k < BEAD_POINTS; k++)
+        {
+            float a0 = 2 * pi * k / BEAD_POINTS;
+            float a1 = 2 * pi * (k + 1) / BEAD_POINTS;
+            pieces.append(sf::Vertex(centre, color));
+            pieces.append(sf::Vertex(centre + sf::Vector2f(radius * std::cos(a0), radius * std::sin(a0)), color));
+            pieces.append(sf::Vertex(centre + sf::Vector2f(radius * std::cos(a1), radius * std::sin(a1)), color));
+        }
+    }
+
+    void addCell(int row, int col, sf::Color color)
+    {
+        float left = float(col * cellSize), top = float(row * cellSize);
+        float right = left + cellSize, bottom = top + cellSize;
+        sf::Vertex corners[4] = {sf::Vertex(sf::Vector2f(left, top), color), sf::Vertex(sf::Vector2f(right, top), color),
+                                 sf::Vertex(sf::Vector2f(right, bottom), color), sf::Vertex(sf::Vector2f(left, bottom), color)};
+        const int triangles[6] = {0, 1, 2, 0, 2, 3};
+        for (int index : triangles)
+            pieces.append(corners[index]);
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bead
+{
+
+// Write-only file opened for appending, with an explicit flush to the
+// disk. write() goes straight to the OS with no user-space buffer, so what
+// it wrote survives the process dying; sync() is what survives the
+// machine losing power, and costs milliseconds rather than microseconds.
+class AppendFile
+{
+public:
+    AppendFile() = default;
+
+    ~AppendFile()
+    {
+        close();
+    }
+
+    AppendFile(const AppendFile &) = delete;
+    AppendFile &operator=(const AppendFile &) = delete;
+
+    bool open(const std::string &path, bool truncate)
+    {
+        close();
+#ifdef _WIN32
+        fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0),
+                   _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0), 0644);
+#endif
+        return fd >= 0;
+    }
+
+    void close()
+    {
+        if (fd < 0)
+            return;
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        fd = -1;
+    }
+
+    bool isOpen() const
+    {
+        return fd >= 0;
+    }
+
+    bool write(const void *data, size_t length)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        while (length > 0)
+        {
+#ifdef _WIN32
+            int written = _write(fd, bytes, unsigned(length));
+#else
+            ssize_t written = ::write(fd, bytes, length);
+#endif
+            if (written <= 0)
+                return false;
+            bytes += written;
+            length -= size_t(written);
+        }
+        return true;
+    }
+
+    bool sync()
+    {
+#ifdef _WIN32
+        return _commit(fd) == 0;
+#elif defined(__APPLE__)
+        return fsync(fd) == 0;
+#else
+        return fdatasync(fd) == 0;
+#endif
+    }
+
+    // Move from over to, replacing to in one step
+    static bool replace(const std::string &from, const std::string &to)
+    {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+private:
+    int fd = -1;
+};
+
+} // namespace bead
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <thread>
+#include "position.h"
+#include "rules.h"
+#include "search.h"
+
+namespace bead
+{
+
+// Runs a Searcher on a background thread so a front end can keep drawing
+// and handling input while the computer thinks. start() returns at once;
+// poll ready() and collect the move with get(), or pass a callback, which
+// is called on the search thread once the result is ready. cancel() stops the
+// search and drops its result. The Searcher must not be used by anything
+// else until the search has been collected or cancelled.
+template <int N>
+class AsyncSearch
+{
+public:
+    using Callback = std::function<void(const SearchResult &)>;
+
+    explicit AsyncSearch(Searcher<N> &searcher)
+        : searcher(searcher)
+    {
+    }
+
+    ~AsyncSearch()
+    {
+        cancel();
+    }
+
+    AsyncSearch(const AsyncSearch &) = delete;
+    AsyncSearch &operator=(const AsyncSearch &) = delete;
+
+    // Start searching a copy of root; false if a search is already under way
+    bool start(const Position<N> &root, const SearchLimits &limits, const Rules &rules = Rules(),
+               Callback onDone = Callback())
+    {
+        if (busy())
+            return false;
+        this->root = root;
+        std::promise<SearchResult> promise;
+        pending = promise.get_future();
+        worker = std::thread([this, limits, rules, onDone, promise = std::move(promise)]() mutable {
+            SearchResult result = searcher.search(this->root, limits, rules);
+            promise.set_value(result);
+            if (onDone)
+                onDone(result);
+        });
+        return true;
+    }
+
+    // A search has been started and its result not yet collected
+    bool busy() const
+    {
+        return pending.valid();
+    }
+
+    // The result is waiting and get() will not block
+    bool ready() const
+    {
+        return busy() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Key of the position being searched, to check the result still applies
+    uint64_t key() const
+    {
+        return root.key();
+    }
+
+    // Wait for the search and take its result
+    SearchResult get()
+    {
+        SearchResult result = pending.get();
+        worker.join();
+        return result;
+    }
+
+    // Stop the search, wait for its thread and discard the result
+    void cancel()
+    {
+        if (!busy())
+            return;
+        // Repeat the request in case the search had not yet started and reset its flag
+        while (pending.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+            searcher.stopSearch();
+        pending.get();
+        worker.join();
+    }
+
+private:
+    Searcher<N> &searcher;
+    Position<N> root;
+    std::future<SearchResult> pending;
+    std::thread worker;
+};
+
+} // namespace bead
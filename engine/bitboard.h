@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace bead
+{
+
+// Step directions. The first four are orthogonal, the last four diagonal.
+enum Direction
+{
+    NORTH,
+    SOUTH,
+    EAST,
+    WEST,
+    NORTH_EAST,
+    NORTH_WEST,
+    SOUTH_EAST,
+    SOUTH_WEST,
+    DIRECTION_COUNT
+};
+
+// The direction that takes a step in dir back
+constexpr int oppositeDirection(int dir)
+{
+    return dir < NORTH_EAST ? dir ^ 1 : NORTH_EAST + SOUTH_WEST - dir;
+}
+
+// Direction sets, one bit per Direction
+const unsigned ALL_DIRECTIONS = 0xFF;
+const unsigned DIAGONAL_DIRECTIONS = (1u << NORTH_EAST) | (1u << NORTH_WEST) |
+                                     (1u << SOUTH_EAST) | (1u << SOUTH_WEST);
+
+// Call f(std::integral_constant<int, dir>{}) for every direction in order.
+// The loop is unrolled at compile time, so each call sees its direction as
+// a constant and shift() compiles to a single shift and mask. Always
+// inlined: as a call, the masks f updates would go through memory.
+template <typename F, int... Dirs>
+__attribute__((always_inline)) inline void forEachDirection(F &&f, std::integer_sequence<int, Dirs...>)
+{
+    (f(std::integral_constant<int, Dirs>{}), ...);
+}
+
+template <typename F>
+__attribute__((always_inline)) inline void forEachDirection(F &&f)
+{
+    forEachDirection(f, std::make_integer_sequence<int, DIRECTION_COUNT>{});
+}
+
+inline int popCount(uint32_t mask)
+{
+    return __builtin_popcount(mask);
+}
+
+inline int popCount(uint64_t mask)
+{
+    return __builtin_popcountll(mask);
+}
+
+// Index of the lowest set bit; mask must not be zero
+inline int lowestBit(uint32_t mask)
+{
+    return __builtin_ctz(mask);
+}
+
+inline int lowestBit(uint64_t mask)
+{
+    return __builtin_ctzll(mask);
+}
+
+#ifdef __SIZEOF_INT128__
+using Mask128 = unsigned __int128;
+
+inline int popCount(Mask128 mask)
+{
+    return __builtin_popcountll(uint64_t(mask)) + __builtin_popcountll(uint64_t(mask >> 64));
+}
+
+inline int lowestBit(Mask128 mask)
+{
+    uint64_t low = uint64_t(mask);
+    return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll(uint64_t(mask >> 64));
+}
+#endif
+
+// Narrowest mask type with a bit for each of the cells of an N x N grid:
+// 32 bits up to 5x5, 64 bits up to 8x8 and 128 bits up to 11x11
+template <int N>
+struct MaskType
+{
+#ifdef __SIZEOF_INT128__
+    static_assert(N * N <= 128, "grid must fit in a 128-bit mask");
+    using type = std::conditional_t<(N * N <= 32), uint32_t, std::conditional_t<(N * N <= 64), uint64_t, Mask128>>;
+#else
+    static_assert(N * N <= 64, "grid must fit in a 64-bit mask");
+    using type = std::conditional_t<(N * N <= 32), uint32_t, uint64_t>;
+#endif
+};
+
+// Position of an N x N grid as one bit mask per player.
+// Cell (row, col) is bit row * N + col. Every size is its own type, so
+// shifts, edge masks and move tables are constants of the instantiation.
+template <int N>
+struct BitBoard
+{
+    static_assert(N >= 2, "grid must have at least two rows");
+
+    using Mask = typename MaskType<N>::type;
+
+    static constexpr int SIZE = N;
+    static constexpr int CELLS = N * N;
+    static constexpr Mask FULL = CELLS == int(8 * sizeof(Mask)) ? ~Mask(0) : (Mask(1) << CELLS) - 1;
+
+    Mask beads[2] = {0, 0}; // beads[0] for player 1, beads[1] for player 2
+
+    static constexpr int square(int row, int col)
+    {
+        return row * N + col;
+    }
+
+    static constexpr Mask bit(int square)
+    {
+        return Mask(1) << square;
+    }
+
+    static constexpr Mask columnMask(int col)
+    {
+        Mask mask = 0;
+        for (int row = 0; row < N; row++)
+            mask |= bit(square(row, col));
+        return mask;
+    }
+
+    static constexpr Mask rowMask(int row)
+    {
+        Mask mask = 0;
+        for (int col = 0; col < N; col++)
+            mask |= bit(square(row, col));
+        return mask;
+    }
+
+    static constexpr Mask NOT_FIRST_COLUMN = FULL & ~columnMask(0);
+    static constexpr Mask NOT_LAST_COLUMN = FULL & ~columnMask(N - 1);
+
+    // Change in square index for one step in the given direction
+    static constexpr int offset(int dir)
+    {
+        switch (dir)
+        {
+        case NORTH:
+            return -N;
+        case SOUTH:
+            return N;
+        case EAST:
+            return 1;
+        case WEST:
+            return -1;
+        case NORTH_EAST:
+            return 1 - N;
+        case NORTH_WEST:
+            return -N - 1;
+        case SOUTH_EAST:
+            return N + 1;
+        case SOUTH_WEST:
+            return N - 1;
+        }
+        return 0;
+    }
+
+    // Move every bit one cell in the given direction, dropping bits that leave the grid.
+    // M is Mask, or a vector of masks for the batch evaluator (see eval.h).
+    template <typename M>
+    static constexpr M shift(M mask, int dir)
+    {
+        switch (dir)
+        {
+        case NORTH:
+            return mask >> N;
+        case SOUTH:
+            return (mask << N) & FULL;
+        case EAST:
+            return (mask & NOT_LAST_COLUMN) << 1;
+        case WEST:
+            return (mask & NOT_FIRST_COLUMN) >> 1;
+        case NORTH_EAST:
+            return (mask & NOT_LAST_COLUMN) >> (N - 1);
+        case NORTH_WEST:
+            return (mask & NOT_FIRST_COLUMN) >> (N + 1);
+        case SOUTH_EAST:
+            return ((mask & NOT_LAST_COLUMN) << (N + 1)) & FULL;
+        case SOUTH_WEST:
+            return ((mask & NOT_FIRST_COLUMN) << (N - 1)) & FULL;
+        }
+        return M();
+    }
+
+    // Bead owner at a cell: 0 for empty, otherwise the player number
+    int at(int row, int col) const
+    {
+        Mask b = bit(square(row, col));
+        if (beads[0] & b)
+            return 1;
+        if (beads[1] & b)
+            return 2;
+        return 0;
+    }
+
+    void set(int row, int col, int player)
+    {
+        Mask b = bit(square(row, col));
+        beads[0] &= ~b;
+        beads[1] &= ~b;
+        if (player == 1 || player == 2)
+            beads[player - 1] |= b;
+    }
+
+    void clear()
+    {
+        beads[0] = 0;
+        beads[1] = 0;
+    }
+
+    Mask own(int player) const
+    {
+        return beads[player - 1];
+    }
+
+    Mask opponent(int player) const
+    {
+        return beads[2 - player];
+    }
+
+    Mask occupied() const
+    {
+        return beads[0] | beads[1];
+    }
+
+    Mask empty() const
+    {
+        return ~occupied() & FULL;
+    }
+
+    int count(int player) const
+    {
+        return popCount(own(player));
+    }
+
+    // Empty cells one of the player's beads can step to
+    Mask stepTargets(int player) const
+    {
+        Mask from = own(player);
+        Mask targets = 0;
+        forEachDirection([&](auto dir) { targets |= shift(from, dir); });
+        return targets & empty();
+    }
+
+    // Empty cells reachable by jumping over an adjacent opponent bead
+    Mask jumpTargets(int player, unsigned directions = ALL_DIRECTIONS) const
+    {
+        Mask from = own(player);
+        Mask prey = opponent(player);
+        Mask targets = 0;
+        forEachDirection([&](auto dir) {
+            if (directions & (1u << dir))
+                targets |= shift(shift(from, dir) & prey, dir);
+        });
+        return targets & empty();
+    }
+
+    bool hasMoves(int player, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        return (stepTargets(player) | jumpTargets(player, jumpDirections)) != 0;
+    }
+
+    // Number of legal moves of the player: a step or a jump per bead and direction
+    int moveCount(int player, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        Mask from = own(player);
+        Mask prey = opponent(player);
+        Mask open = empty();
+        int moves = 0;
+        forEachDirection([&](auto dir) {
+            Mask step = shift(from, dir);
+            moves += popCount(step & open);
+            if (jumpDirections & (1u << dir))
+                moves += popCount(shift(step & prey, dir) & open);
+        });
+        return moves;
+    }
+};
+
+} // namespace bead
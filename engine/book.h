@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "mapped_file.h"
+#include "movegen.h"
+#include "position.h"
+#include "rules.h"
+
+namespace bead
+{
+
+// Opening book: moves played from early positions in self-play, with how
+// they scored. The file is a header followed by entries sorted by
+// position key, so it is used straight from a memory map: a probe is a
+// binary search with no parsing and no allocation.
+
+const uint32_t BOOK_MAGIC = 0x314B4242; // "BBK1"
+const uint16_t BOOK_VERSION = 1;
+
+struct BookHeader
+{
+    uint32_t magic = BOOK_MAGIC;
+    uint16_t version = BOOK_VERSION;
+    uint8_t size = 0; // grid size N
+    uint8_t reserved = 0;
+    uint32_t jumpDirections = 0;
+    uint32_t reserved2 = 0;
+    uint64_t entryCount = 0;
+};
+
+struct BookEntry
+{
+    uint64_t key = 0; // Zobrist key of the position before the move
+    uint8_t from = 0;
+    uint8_t to = 0;
+    uint8_t flags = 0;
+    uint8_t reserved = 0;
+    uint32_t games = 0;
+    uint32_t wins = 0; // for the side that played the move
+    uint32_t draws = 0;
+
+    Move move() const
+    {
+        return Move{from, to, flags};
+    }
+
+    // Points per game for the side that played the move, 0 to 1
+    double score() const
+    {
+        return games ? (wins + 0.5 * draws) / games : 0;
+    }
+};
+
+static_assert(sizeof(BookHeader) == 24 && sizeof(BookEntry) == 24, "book records are stored as is");
+
+template <int N>
+class OpeningBook
+{
+public:
+    // Moves scoring within this much of the best one are picked at random,
+    // in proportion to how often they were played
+    static constexpr double SCORE_MARGIN = 0.05;
+
+    bool open(const std::string &path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+        if (file.size() < sizeof(BookHeader))
+        {
+            close();
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != BOOK_MAGIC || header.version != BOOK_VERSION || header.size != N ||
+            header.entryCount > (file.size() - sizeof(BookHeader)) / sizeof(BookEntry))
+        {
+            close();
+            return false;
+        }
+        entries = reinterpret_cast<const BookEntry *>(file.data() + sizeof(BookHeader));
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        header = BookHeader();
+        entries = nullptr;
+    }
+
+    bool isOpen() const
+    {
+        return entries != nullptr;
+    }
+
+    uint64_t size() const
+    {
+        return header.entryCount;
+    }
+
+    // Pick a book move for the side to move; false if the position is not
+    // in the book. random varies the choice between equally good moves.
+    bool probe(const Position<N> &position, const Rules &rules, Move &move, unsigned random = 0) const
+    {
+        if (!isOpen() || rules.jumpDirections != header.jumpDirections || rules.captureChains)
+            return false;
+
+        uint64_t key = position.key();
+        uint64_t low = 0, high = header.entryCount;
+        while (low < high)
+        {
+            uint64_t mid = (low + high) / 2;
+            if (entries[mid].key < key)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        // Entries for the key, keeping only moves legal here in case two positions share a key
+        MoveList<N> legal;
+        position.generateMoves(legal, rules.jumpDirections);
+        double best = -1;
+        uint64_t end = low;
+        for (; end < header.entryCount && entries[end].key == key; end++)
+        {
+            if (legal.find(entries[end].from, entries[end].to) >= 0 && entries[end].score() > best)
+                best = entries[end].score();
+        }
+        if (best < 0)
+            return false;
+
+        uint64_t total = 0;
+        for (uint64_t i = low; i < end; i++)
+        {
+            if (legal.find(entries[i].from, entries[i].to) >= 0 && entries[i].score() >= best - SCORE_MARGIN)
+                total += entries[i].games;
+        }
+        uint64_t pick = total ? random % total : 0;
+        for (uint64_t i = low; i < end; i++)
+        {
+            if (legal.find(entries[i].from, entries[i].to) < 0 || entries[i].score() < best - SCORE_MARGIN)
+                continue;
+            if (pick < entries[i].games)
+            {
+                move = legal[legal.find(entries[i].from, entries[i].to)];
+                return true;
+            }
+            pick -= entries[i].games;
+        }
+        return false;
+    }
+
+private:
+    MappedFile file;
+    BookHeader header;
+    const BookEntry *entries = nullptr;
+};
+
+} // namespace bead
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+#include "movegen.h"
+
+namespace bead
+{
+
+// One turn of consecutive jumps by a single bead under Rules::captureChains:
+// where it starts, how many jumps it makes and which beads it takes. The
+// squares it lands on are kept in the ChainList it belongs to.
+template <int N>
+struct CaptureChain
+{
+    using Mask = typename BitBoard<N>::Mask;
+
+    uint8_t from = 0;
+    uint8_t to = 0;      // last landing square
+    uint8_t length = 0;  // jumps, at least one
+    uint16_t first = 0;  // first landing square's index in the list's square pool
+    Mask captured = 0;
+};
+
+// Every capture chain of one position, in fixed storage meant to live on
+// the stack. Two chains are the same turn when they start and end on the
+// same squares and take the same beads, whatever the order of the jumps;
+// only the first of them is kept. A position with more chains or longer
+// ones than the list holds sets overflowed() and keeps those found so far.
+template <int N>
+class ChainList
+{
+public:
+    using Mask = typename BitBoard<N>::Mask;
+
+    static constexpr int CAPACITY = 1024;       // chains
+    static constexpr int SQUARE_CAPACITY = 8192; // landing squares of all chains together
+
+    void clear()
+    {
+        for (int i = 0; i < count; i++)
+            slots[slotOf[i]] = 0;
+        count = 0;
+        squareCount = 0;
+        full = false;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    bool overflowed() const
+    {
+        return full;
+    }
+
+    const CaptureChain<N> &operator[](int i) const
+    {
+        return chains[i];
+    }
+
+    // Square chain i lands on after its jump k
+    int square(int i, int k) const
+    {
+        return squares[chains[i].first + k];
+    }
+
+    // Jump k of chain i as a move: every jump but the last continues the turn
+    Move hop(int i, int k) const
+    {
+        int from = k == 0 ? chains[i].from : square(i, k - 1);
+        uint8_t flags = k + 1 < chains[i].length ? MOVE_CAPTURE | MOVE_CONTINUES : MOVE_CAPTURE;
+        return Move{uint8_t(from), uint8_t(square(i, k)), flags};
+    }
+
+    // Index of the chain from -> to taking the most beads, or -1 for none
+    int find(int from, int to) const
+    {
+        int found = -1;
+        for (int i = 0; i < count; i++)
+        {
+            if (chains[i].from == from && chains[i].to == to &&
+                (found < 0 || popCount(chains[i].captured) > popCount(chains[found].captured)))
+                found = i;
+        }
+        return found;
+    }
+
+    // Record a chain; false when an equivalent one is already in the list
+    // or the list is full
+    bool add(int from, const uint8_t *path, int length, Mask captured)
+    {
+        int to = path[length - 1];
+        unsigned slot = hash(from, to, captured) & (SLOTS - 1);
+        for (; slots[slot] != 0; slot = (slot + 1) & (SLOTS - 1))
+        {
+            const CaptureChain<N> &other = chains[slots[slot] - 1];
+            if (other.from == from && other.to == to && other.captured == captured)
+                return false;
+        }
+        if (count == CAPACITY || squareCount + length > SQUARE_CAPACITY)
+        {
+            full = true;
+            return false;
+        }
+
+        CaptureChain<N> &chain = chains[count];
+        chain.from = uint8_t(from);
+        chain.to = uint8_t(to);
+        chain.length = uint8_t(length);
+        chain.first = uint16_t(squareCount);
+        chain.captured = captured;
+        for (int k = 0; k < length; k++)
+            squares[squareCount++] = path[k];
+        slotOf[count] = uint16_t(slot);
+        slots[slot] = uint16_t(++count);
+        return true;
+    }
+
+private:
+    // Open addressing over chain indices + 1, at most half full
+    static constexpr int SLOTS = 2 * CAPACITY;
+
+    CaptureChain<N> chains[CAPACITY];
+    uint8_t squares[SQUARE_CAPACITY];
+    uint16_t slots[SLOTS] = {};
+    uint16_t slotOf[CAPACITY]; // slot of each chain, so clear() touches only those
+    int count = 0;
+    int squareCount = 0;
+    bool full = false;
+
+    static unsigned hash(int from, int to, Mask captured)
+    {
+        uint64_t h = uint64_t(captured);
+        if constexpr (sizeof(Mask) > sizeof(uint64_t))
+            h ^= uint64_t(captured >> 64);
+        h ^= uint64_t(from) << 56 ^ uint64_t(to) << 48;
+        h *= 0x9E3779B97F4A7C15ull;
+        return unsigned(h >> 40);
+    }
+};
+
+// Depth-first walk of every chain of one player. The jumps are played on a
+// single working board and taken back on the way up, so the walk copies
+// nothing and needs no memory beyond the path to the current jump.
+template <int N>
+class ChainWalker
+{
+public:
+    using Board = BitBoard<N>;
+    using Mask = typename Board::Mask;
+
+    ChainWalker(const Board &board, int player, unsigned jumpDirections, ChainList<N> &list)
+        : work(board), player(player), jumpDirections(jumpDirections), list(list)
+    {
+    }
+
+    void walk()
+    {
+        // Only beads with a first jump start a chain: a bead of the
+        // opponent next to them and an empty cell behind it
+        Mask starts = 0;
+        forEachDirection([&](auto dir) {
+            constexpr int back = oppositeDirection(dir);
+            if (jumpDirections & (1u << dir))
+                starts |= Board::shift(Board::shift(work.empty(), back) & work.opponent(player), back);
+        });
+        starts &= work.own(player);
+        while (starts && !list.overflowed())
+        {
+            int from = lowestBit(starts);
+            starts &= starts - 1;
+            walk(from, from, 0, Mask(0));
+        }
+    }
+
+private:
+    Board work;
+    int player;
+    unsigned jumpDirections;
+    ChainList<N> &list;
+
+    // Squares landed on so far; every jump takes a bead, so no chain is longer
+    uint8_t path[N * N];
+
+    // Every prefix of a chain is a turn of its own, since the bead may stop.
+    // A chain equivalent to one already found leaves the board as that one
+    // did, so everything that could follow it has been found too.
+    void walk(int from, int at, int length, Mask captured)
+    {
+        Mask here = Board::bit(at);
+        forEachDirection([&](auto dir) {
+            if (!(jumpDirections & (1u << dir)) || list.overflowed())
+                return;
+            Mask over = Board::shift(here, dir) & work.opponent(player);
+            Mask land = Board::shift(over, dir) & work.empty();
+            if (!land)
+                return;
+
+            Move jump{uint8_t(at), uint8_t(lowestBit(land)), MOVE_CAPTURE};
+            path[length] = jump.to;
+            if (!list.add(from, path, length + 1, captured | over))
+                return;
+            applyMove(work, player, jump);
+            walk(from, jump.to, length + 1, captured | over);
+            undoMove(work, player, jump);
+        });
+    }
+};
+
+// Write every capture chain player has into list. Single jumps are chains
+// of length one, so under Rules::captureChains these are all the captures.
+template <int N>
+void generateChains(const BitBoard<N> &board, int player, ChainList<N> &list,
+                    unsigned jumpDirections = ALL_DIRECTIONS)
+{
+    list.clear();
+    ChainWalker<N>(board, player, jumpDirections, list).walk();
+}
+
+} // namespace bead
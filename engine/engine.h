@@ -0,0 +1,25 @@
+#pragma once
+
+// Headless bead engine: board representation, rules, move generation,
+// evaluation, search, opening book, endgame tables, saved games, the crash journal and
+// the game database. Header-only, with no dependency beyond the C++17
+// standard library and the system's file calls, so it builds into the SFML
+// front end, the console game and command-line tools alike.
+
+#include "async_search.h"
+#include "bitboard.h"
+#include "book.h"
+#include "chains.h"
+#include "eval.h"
+#include "game.h"
+#include "gamedb.h"
+#include "geometry.h"
+#include "journal.h"
+#include "movegen.h"
+#include "position.h"
+#include "rules.h"
+#include "save_format.h"
+#include "search.h"
+#include "tablebase.h"
+#include "tt.h"
+#include "zobrist.h"
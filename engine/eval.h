@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "bitboard.h"
+#include "position.h"
+
+namespace bead
+{
+
+// Weights of the evaluation terms, in hundredths of a bead. Each term is
+// a count for the side to move minus the same count for the opponent.
+struct EvalWeights
+{
+    int material = 100; // beads
+    int mobility = 4;   // empty cells a bead can step or jump to
+    int threats = 30;   // opposing beads that can be captured right now
+    int centre = 6;     // beads in the centre of the board
+    int backRow = 8;    // beads still guarding their own back row
+};
+
+// uint64_t masks processed together, one position per lane: as many as
+// the target's vector registers hold, two with SSE2 and four with AVX2.
+// GCC and Clang vector extensions, so the same code serves both.
+#ifdef __AVX2__
+typedef uint64_t EvalLanes __attribute__((vector_size(32)));
+#else
+typedef uint64_t EvalLanes __attribute__((vector_size(16)));
+#endif
+
+const int EVAL_LANES = int(sizeof(EvalLanes) / sizeof(uint64_t));
+
+// Bit count of every lane, by the usual SWAR reduction; only shifts, adds
+// and masks, so it stays in vector registers where a popcount would not
+inline EvalLanes popCountLanes(EvalLanes x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x += x >> 8;
+    x += x >> 16;
+    x += x >> 32;
+    return x & 0x7F;
+}
+
+// Static evaluation from the point of view of the side to move. evaluate()
+// is the scalar reference and what the search calls at its leaves;
+// evaluateBatch() scores many positions at once, EVAL_LANES at a time, and
+// gives the same scores.
+template <int N>
+class Evaluator
+{
+public:
+    using Board = BitBoard<N>;
+    using Mask = typename Board::Mask;
+
+    explicit Evaluator(const EvalWeights &weights = EvalWeights())
+        : weights(weights)
+    {
+    }
+
+    const EvalWeights &getWeights() const
+    {
+        return weights;
+    }
+
+    void setWeights(const EvalWeights &weights)
+    {
+        this->weights = weights;
+    }
+
+    int evaluate(const Board &board, int player, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        Mask us = board.own(player);
+        Mask them = board.opponent(player);
+        Mask reach[2] = {board.stepTargets(player) | board.jumpTargets(player, jumpDirections),
+                         board.stepTargets(3 - player) | board.jumpTargets(3 - player, jumpDirections)};
+        return weights.material * (popCount(us) - popCount(them)) +
+               weights.mobility * (popCount(reach[0]) - popCount(reach[1])) +
+               weights.threats * (popCount(prey(us, them, board.empty(), jumpDirections)) -
+                                  popCount(prey(them, us, board.empty(), jumpDirections))) +
+               weights.centre * (popCount(us & CENTRE) - popCount(them & CENTRE)) +
+               weights.backRow * (popCount(us & backRow(player)) - popCount(them & backRow(3 - player)));
+    }
+
+    int evaluate(const Position<N> &position, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        return evaluate(position.bitboard(), position.sideToMove(), jumpDirections);
+    }
+
+    // scores[i] = evaluate(positions[i]) for every i < count
+    void evaluateBatch(const Position<N> *positions, size_t count, int *scores,
+                       unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        size_t i = 0;
+        if constexpr (sizeof(Mask) <= sizeof(uint64_t))
+        {
+            for (; i + EVAL_LANES <= count; i += EVAL_LANES)
+                evaluateLanes(positions + i, scores + i, jumpDirections);
+        }
+        for (; i < count; i++)
+            scores[i] = evaluate(positions[i], jumpDirections);
+    }
+
+private:
+    EvalWeights weights;
+
+    static constexpr Mask centreMask()
+    {
+        Mask mask = 0;
+        for (int row = N / 3; row < N - N / 3; row++)
+        {
+            for (int col = N / 3; col < N - N / 3; col++)
+                mask |= Board::bit(Board::square(row, col));
+        }
+        return mask;
+    }
+
+    static constexpr Mask CENTRE = centreMask();
+
+    // Player 1 starts at the top and player 2 at the bottom
+    static constexpr Mask backRow(int player)
+    {
+        return Board::rowMask(player == 1 ? 0 : N - 1);
+    }
+
+    // Beads of them that us can jump over right now: a bead of us on one
+    // side and an empty cell on the other. M is Mask or EvalLanes.
+    template <typename M>
+    static M prey(M us, M them, M empty, unsigned jumpDirections)
+    {
+        M found = M();
+        forEachDirection([&](auto dir) {
+            if (jumpDirections & (1u << dir))
+                found |= Board::shift(us, dir) & them & Board::shift(empty, oppositeDirection(dir));
+        });
+        return found;
+    }
+
+    // Cells player can step or jump to
+    static EvalLanes reach(EvalLanes own, EvalLanes other, EvalLanes empty, unsigned jumpDirections)
+    {
+        EvalLanes targets = EvalLanes();
+        forEachDirection([&](auto dir) {
+            EvalLanes step = Board::shift(own, dir);
+            targets |= step;
+            if (jumpDirections & (1u << dir))
+                targets |= Board::shift(step & other, dir);
+        });
+        return targets & empty;
+    }
+
+    void evaluateLanes(const Position<N> *positions, int *scores, unsigned jumpDirections) const
+    {
+        EvalLanes us, them, home[2];
+        for (int lane = 0; lane < EVAL_LANES; lane++)
+        {
+            const Board &board = positions[lane].bitboard();
+            int player = positions[lane].sideToMove();
+            us[lane] = board.own(player);
+            them[lane] = board.opponent(player);
+            home[0][lane] = backRow(player);
+            home[1][lane] = backRow(3 - player);
+        }
+        EvalLanes empty = ~(us | them) & Board::FULL;
+
+        // Differences wrap around in the unsigned lanes and come out right
+        // once read back as signed
+        EvalLanes score = (popCountLanes(us) - popCountLanes(them)) * uint64_t(weights.material);
+        score += (popCountLanes(reach(us, them, empty, jumpDirections)) -
+                  popCountLanes(reach(them, us, empty, jumpDirections))) *
+                 uint64_t(weights.mobility);
+        score += (popCountLanes(prey(us, them, empty, jumpDirections)) -
+                  popCountLanes(prey(them, us, empty, jumpDirections))) *
+                 uint64_t(weights.threats);
+        score += (popCountLanes(us & CENTRE) - popCountLanes(them & CENTRE)) * uint64_t(weights.centre);
+        score += (popCountLanes(us & home[0]) - popCountLanes(them & home[1])) * uint64_t(weights.backRow);
+        for (int lane = 0; lane < EVAL_LANES; lane++)
+            scores[lane] = int(int64_t(score[lane]));
+    }
+};
+
+} // namespace bead
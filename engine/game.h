@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "chains.h"
+#include "geometry.h"
+#include "movegen.h"
+#include "position.h"
+#include "rules.h"
+#include "search.h"
+
+namespace bead
+{
+
+// One game of beads: position, rules, the moves played since the setup and
+// the rule checks the front ends use. A Game owns no global state and is
+// small (two positions and its move list), so a process can keep thousands
+// of them. Searchers are much larger (move-ordering
+// tables and a transposition table) and are meant to be shared, one per
+// thread, between the games that thread serves.
+template <int N>
+class Game
+{
+public:
+    using Geo = Geometry<N>;
+
+    static constexpr int SIZE = N;
+
+    explicit Game(Rules rules = Rules())
+        : gameRules(rules)
+    {
+        reset();
+    }
+
+    // Starting setup: the first N / 3 rows for player 1, the last N / 3 for player 2
+    void reset()
+    {
+        pos.clear();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                if (i < N / 3)
+                    pos.set(i, j, 1);
+                else if (i >= N - N / 3)
+                    pos.set(i, j, 2);
+            }
+        }
+        restart();
+    }
+
+    // Remove every bead; player 1 to move
+    void clear()
+    {
+        pos.clear();
+        restart();
+    }
+
+    const Position<N> &position() const
+    {
+        return pos;
+    }
+
+    const Rules &rules() const
+    {
+        return gameRules;
+    }
+
+    // Position the move history starts from: the last setup change
+    const Position<N> &startPosition() const
+    {
+        return start;
+    }
+
+    // Moves played from startPosition(), passes included
+    const std::vector<Move> &history() const
+    {
+        return moves;
+    }
+
+    int sideToMove() const
+    {
+        return pos.sideToMove();
+    }
+
+    int at(int row, int col) const
+    {
+        return pos.at(row, col);
+    }
+
+    // Editing the position starts a new history from it
+    void set(int row, int col, int player)
+    {
+        pos.set(row, col, player);
+        restart();
+    }
+
+    void setSideToMove(int player)
+    {
+        pos.setSideToMove(player);
+        restart();
+    }
+
+    static bool isValid(int row, int col)
+    {
+        return row >= 0 && col >= 0 && row < N && col < N;
+    }
+
+    bool isEmpty(int row, int col) const
+    {
+        return pos.at(row, col) == 0;
+    }
+
+    // Distance rule of the original game; 3 for a knight's offset
+    static int calculateDistance(int srcRow, int srcCol, int desRow, int desCol)
+    {
+        return Geo::TABLES.distance[srcRow * N + srcCol][desRow * N + desCol];
+    }
+
+    // A step to an empty neighbouring cell
+    bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol) const
+    {
+        if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+            return false;
+        if (pos.at(srcRow, srcCol) != player || !isEmpty(desRow, desCol))
+            return false;
+        return Geo::isStep(srcRow * N + srcCol, desRow * N + desCol);
+    }
+
+    // A jump over an opponent bead to the empty cell behind it
+    bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol) const
+    {
+        if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+            return false;
+        if (pos.at(srcRow, srcCol) != player || !isEmpty(desRow, desCol))
+            return false;
+
+        int src = srcRow * N + srcCol;
+        int des = desRow * N + desCol;
+        if (!Geo::isJump(src, des, gameRules.jumpDirections))
+            return false;
+        const BitBoard<N> &board = pos.bitboard();
+        return (board.opponent(player) & board.bit(Geo::middle(src, des))) != 0;
+    }
+
+    bool hasValidMoves(int player) const
+    {
+        return mobility[player - 1] > 0;
+    }
+
+    // Legal moves player would have if it were their turn
+    int moveCount(int player) const
+    {
+        return mobility[player - 1];
+    }
+
+    // The side to move still has beads but none of them can move, which
+    // loses the game
+    bool isBlocked() const
+    {
+        return mobility[pos.sideToMove() - 1] == 0 && pos.count(pos.sideToMove()) > 0;
+    }
+
+    void generateMoves(MoveList<N> &moves) const
+    {
+        pos.generateMoves(moves, gameRules.jumpDirections);
+    }
+
+    // Every capture of the side to move under Rules::captureChains
+    void generateChains(ChainList<N> &chains) const
+    {
+        bead::generateChains(pos.bitboard(), pos.sideToMove(), chains, gameRules.jumpDirections);
+    }
+
+    // Play a move for the side to move; false if it is not legal. With
+    // capture chains the destination may also be where a chain ends; of
+    // the chains that end there, the one taking the most beads is played.
+    bool makeMove(int srcRow, int srcCol, int desRow, int desCol)
+    {
+        int player = pos.sideToMove();
+        Move move{uint8_t(srcRow * N + srcCol), uint8_t(desRow * N + desCol), 0};
+        if (isEdible(player, srcRow, srcCol, desRow, desCol))
+            move.flags = MOVE_CAPTURE;
+        else if (!isMovable(player, srcRow, srcCol, desRow, desCol))
+        {
+            if (!gameRules.captureChains || !isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+                return false;
+            ChainList<N> chains;
+            generateChains(chains);
+            int chain = chains.find(move.from, move.to);
+            if (chain < 0)
+                return false;
+            playChain(chains, chain);
+            return true;
+        }
+        play(move);
+        return true;
+    }
+
+    // Play chain i of chains, one jump at a time
+    void playChain(const ChainList<N> &chains, int i)
+    {
+        for (int k = 0; k < chains[i].length; k++)
+            play(chains.hop(i, k));
+    }
+
+    // Play a move taken from generateMoves or a search result
+    void play(Move move)
+    {
+        pos.make(move);
+        moves.push_back(move);
+        update();
+    }
+
+    // Hand the turn to the other player without moving
+    void passTurn()
+    {
+        pos.passTurn();
+        moves.push_back(Move{0, 0, MOVE_PASS});
+        update();
+    }
+
+    // Destinations for the side to move's bead at (row, col)
+    void findPossibleMoves(int row, int col, std::vector<std::pair<int, int>> &possibleMoves) const
+    {
+        MoveList<N> moves;
+        generateMoves(moves);
+
+        possibleMoves.clear();
+        int src = row * N + col;
+        for (const Move &move : moves)
+        {
+            if (move.from == src)
+                possibleMoves.push_back({move.to / N, move.to % N});
+        }
+        if (!gameRules.captureChains)
+            return;
+
+        // Ends of longer chains, each listed once
+        ChainList<N> chains;
+        generateChains(chains);
+        for (int i = 0; i < chains.size(); i++)
+        {
+            std::pair<int, int> end{chains[i].to / N, chains[i].to % N};
+            if (chains[i].from == src && chains[i].length > 1 &&
+                std::find(possibleMoves.begin(), possibleMoves.end(), end) == possibleMoves.end())
+                possibleMoves.push_back(end);
+        }
+    }
+
+    // The player who has taken every opposing bead, or 0 while both have beads
+    int winner() const
+    {
+        return winningPlayer;
+    }
+
+    // Let searcher pick and play a move for the side to move
+    bool computerMove(Searcher<N> &searcher, const SearchLimits &limits, SearchResult *report = nullptr)
+    {
+        SearchResult result = searcher.search(pos, limits, gameRules);
+        if (report)
+            *report = result;
+        if (!result.hasMove)
+            return false;
+        play(result.best);
+        return true;
+    }
+
+private:
+    Position<N> pos;
+    Position<N> start;
+    std::vector<Move> moves;
+    Rules gameRules;
+
+    // Game state, worked out once per change of position so that polling
+    // it (every frame in the front ends) costs nothing
+    int winningPlayer = 0;
+    int mobility[2] = {0, 0}; // legal moves per player
+
+    void restart()
+    {
+        start = pos;
+        moves.clear();
+        update();
+    }
+
+    void update()
+    {
+        winningPlayer = pos.count(1) == 0 ? 2 : pos.count(2) == 0 ? 1 : 0;
+        mobility[0] = pos.moveCount(1, gameRules.jumpDirections);
+        mobility[1] = pos.moveCount(2, gameRules.jumpDirections);
+    }
+};
+
+} // namespace bead
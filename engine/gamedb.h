@@ -0,0 +1,475 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "game.h"
+#include "mapped_file.h"
+#include "movegen.h"
+#include "position.h"
+#include "rules.h"
+
+namespace bead
+{
+
+// Archive of finished games with an index of every position they reach.
+// GameDBWriter collects games and writes the file; GameDB maps it and
+// answers queries without parsing or loading it.
+//
+// The file is columnar: one array per field, so a query touches only the
+// columns it needs. Moves are stored as their index in the legal move list
+// of the position they were played from (the list's size stands for a
+// pass), in just enough bits for that list: about five bits a move instead
+// of three bytes. Decoding therefore depends on generateMoves' order; a
+// change to that order needs a new GDB_VERSION.
+//
+// File layout, all little-endian, each section 8-byte aligned:
+//   GameDBHeader
+//   starts[startCount]        start positions: N * N cells, then the side to move
+//   results[gameCount]        uint8_t: winner, 0 for a draw or unfinished game
+//   plies[gameCount]          uint32_t: moves and passes in the game
+//   moveOffsets[gameCount]    uint64_t: first byte of the game's moves
+//   startIds[gameCount]       uint32_t: index into starts
+//   moves[moveBytes]          bit-packed moves, each game from a byte boundary
+//   index[indexCount]         GDBIndexEntry, sorted by position key
+//   postings[postingCount]    uint32_t game ids, ascending within each entry
+
+const uint32_t GDB_MAGIC = 0x42444742; // "BGDB"
+const uint16_t GDB_VERSION = 1;
+
+enum GDBSection
+{
+    GDB_STARTS,
+    GDB_RESULTS,
+    GDB_PLIES,
+    GDB_MOVE_OFFSETS,
+    GDB_START_IDS,
+    GDB_MOVES,
+    GDB_INDEX,
+    GDB_POSTINGS,
+    GDB_SECTIONS
+};
+
+struct GameDBHeader
+{
+    uint32_t magic = GDB_MAGIC;
+    uint16_t version = GDB_VERSION;
+    uint8_t size = 0; // grid size N
+    uint8_t reserved = 0;
+    uint32_t jumpDirections = 0;
+    uint32_t startCount = 0;
+    uint64_t gameCount = 0;
+    uint64_t moveBytes = 0;
+    uint64_t indexCount = 0;
+    uint64_t postingCount = 0;
+    uint64_t sections[GDB_SECTIONS] = {}; // file offset of each section
+};
+
+// One position: the games reaching it and how they ended
+struct GDBIndexEntry
+{
+    uint64_t key = 0;
+    uint64_t firstPosting = 0;
+    uint32_t games = 0;
+    uint32_t wins[2] = {}; // by player 1 and player 2
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(GameDBHeader) == 112 && sizeof(GDBIndexEntry) == 32, "database records are stored as is");
+
+// Bits needed for a value below count
+inline int codeBits(int count)
+{
+    int bits = 0;
+    while ((1 << bits) < count)
+        bits++;
+    return bits;
+}
+
+// Builds a database in memory: 17 bytes a game for the columns, under a
+// byte a move, and 16 bytes per indexed position of each game.
+template <int N>
+class GameDBWriter
+{
+public:
+    static const uint32_t INVALID_GAME = UINT32_MAX;
+
+    // indexPlies limits the index to each game's first plies, to bound
+    // the memory needed for very large archives
+    explicit GameDBWriter(Rules rules = Rules(), uint32_t indexPlies = UINT32_MAX)
+        : dbRules(rules), indexPlies(indexPlies)
+    {
+    }
+
+    // Add a game played under the writer's rules; result is the winner, or
+    // 0 for a draw or a game that did not finish. Returns its id, or
+    // INVALID_GAME if the game holds a move that is not legal here.
+    uint32_t add(const Game<N> &game, int result)
+    {
+        // Encode the moves and note each position once per game
+        Game<N> replay(dbRules);
+        setPosition(replay, game.startPosition());
+        std::vector<uint64_t> keys{replay.position().key()};
+        size_t firstByte = moves.size();
+        MoveList<N> legal;
+        uint64_t bits = 0;
+        int used = 0;
+        for (const Move &move : game.history())
+        {
+            replay.generateMoves(legal);
+            int code = move.isPass() ? legal.size() : legal.find(move.from, move.to);
+            if (code < 0 || (!move.isPass() && legal[code] != move))
+            {
+                moves.resize(firstByte);
+                return INVALID_GAME;
+            }
+            int width = codeBits(legal.size() + 1);
+            bits |= uint64_t(code) << used;
+            used += width;
+            while (used >= 8)
+            {
+                moves.push_back(uint8_t(bits));
+                bits >>= 8;
+                used -= 8;
+            }
+            if (move.isPass())
+                replay.passTurn();
+            else
+                replay.play(move);
+            if (keys.size() <= indexPlies)
+                keys.push_back(replay.position().key());
+        }
+        if (used > 0)
+            moves.push_back(uint8_t(bits));
+
+        uint32_t id = uint32_t(results.size());
+        results.push_back(uint8_t(result));
+        plies.push_back(uint32_t(game.history().size()));
+        moveOffsets.push_back(firstByte);
+        startIds.push_back(startId(game.startPosition()));
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        for (uint64_t key : keys)
+            postings.push_back({key, id});
+        return id;
+    }
+
+    size_t size() const
+    {
+        return results.size();
+    }
+
+    bool write(const std::string &path)
+    {
+        // Group the postings by position, games in order within each
+        std::sort(postings.begin(), postings.end(), [](const Posting &a, const Posting &b) {
+            return a.key != b.key ? a.key < b.key : a.game < b.game;
+        });
+        std::vector<GDBIndexEntry> index;
+        std::vector<uint32_t> games(postings.size());
+        for (size_t i = 0; i < postings.size(); i++)
+        {
+            if (index.empty() || index.back().key != postings[i].key)
+            {
+                GDBIndexEntry entry;
+                entry.key = postings[i].key;
+                entry.firstPosting = i;
+                index.push_back(entry);
+            }
+            GDBIndexEntry &entry = index.back();
+            entry.games++;
+            int result = results[postings[i].game];
+            if (result == 1 || result == 2)
+                entry.wins[result - 1]++;
+            games[i] = postings[i].game;
+        }
+
+        GameDBHeader header;
+        header.size = N;
+        header.jumpDirections = dbRules.jumpDirections;
+        header.startCount = uint32_t(starts.size() / START_BYTES);
+        header.gameCount = results.size();
+        header.moveBytes = moves.size();
+        header.indexCount = index.size();
+        header.postingCount = games.size();
+
+        const void *data[GDB_SECTIONS] = {starts.data(),   results.data(), plies.data(), moveOffsets.data(),
+                                          startIds.data(), moves.data(),   index.data(), games.data()};
+        const size_t bytes[GDB_SECTIONS] = {starts.size(),
+                                            results.size(),
+                                            plies.size() * sizeof(uint32_t),
+                                            moveOffsets.size() * sizeof(uint64_t),
+                                            startIds.size() * sizeof(uint32_t),
+                                            moves.size(),
+                                            index.size() * sizeof(GDBIndexEntry),
+                                            games.size() * sizeof(uint32_t)};
+        uint64_t offset = sizeof(header);
+        for (int s = 0; s < GDB_SECTIONS; s++)
+        {
+            offset = (offset + 7) & ~uint64_t(7);
+            header.sections[s] = offset;
+            offset += bytes[s];
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (int s = 0; s < GDB_SECTIONS; s++)
+        {
+            static const char padding[8] = {};
+            out.write(padding, std::streamsize(header.sections[s] - uint64_t(out.tellp())));
+            out.write(static_cast<const char *>(data[s]), std::streamsize(bytes[s]));
+        }
+        return bool(out);
+    }
+
+    // Put position's beads and side to move on game
+    static void setPosition(Game<N> &game, const Position<N> &position)
+    {
+        game.clear();
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+                game.set(i, j, position.at(i, j));
+        }
+        game.setSideToMove(position.sideToMove());
+    }
+
+private:
+    static constexpr int START_BYTES = N * N + 1;
+
+    struct Posting
+    {
+        uint64_t key;
+        uint32_t game;
+    };
+
+    Rules dbRules;
+    uint32_t indexPlies;
+    std::vector<uint8_t> starts;
+    std::unordered_map<uint64_t, uint32_t> startIndex; // by position key
+    std::vector<uint8_t> results;
+    std::vector<uint32_t> plies;
+    std::vector<uint64_t> moveOffsets;
+    std::vector<uint32_t> startIds;
+    std::vector<uint8_t> moves;
+    std::vector<Posting> postings;
+
+    uint32_t startId(const Position<N> &position)
+    {
+        auto found = startIndex.find(position.key());
+        if (found != startIndex.end())
+            return found->second;
+        uint32_t id = uint32_t(starts.size() / START_BYTES);
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+                starts.push_back(uint8_t(position.at(i, j)));
+        }
+        starts.push_back(uint8_t(position.sideToMove()));
+        startIndex[position.key()] = id;
+        return id;
+    }
+};
+
+// Read-only, memory-mapped game database. Queries are a binary search of
+// the index plus a read of the matching postings; safe to call from any
+// number of threads.
+template <int N>
+class GameDB
+{
+public:
+    struct PositionStats
+    {
+        uint32_t games = 0;
+        uint32_t wins[2] = {}; // by player 1 and player 2
+
+        uint32_t draws() const
+        {
+            return games - wins[0] - wins[1];
+        }
+
+        // Points per game for player, 0 to 1, counting a draw as half
+        double score(int player) const
+        {
+            return games ? (wins[player - 1] + 0.5 * draws()) / games : 0;
+        }
+    };
+
+    bool open(const std::string &path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+        if (!validate())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        header = GameDBHeader();
+    }
+
+    bool isOpen() const
+    {
+        return file.isOpen();
+    }
+
+    uint64_t size() const
+    {
+        return header.gameCount;
+    }
+
+    uint64_t positions() const
+    {
+        return header.indexCount;
+    }
+
+    uint64_t moveBytes() const
+    {
+        return header.moveBytes;
+    }
+
+    Rules rules() const
+    {
+        return Rules{header.jumpDirections};
+    }
+
+    // How the games reaching position ended; false if none did
+    bool stats(const Position<N> &position, PositionStats &result) const
+    {
+        const GDBIndexEntry *entry = find(position.key());
+        result = PositionStats();
+        if (!entry)
+            return false;
+        result.games = entry->games;
+        result.wins[0] = entry->wins[0];
+        result.wins[1] = entry->wins[1];
+        return true;
+    }
+
+    // Ids of the games reaching position, in the order they were added,
+    // at most limit of them
+    void gamesReaching(const Position<N> &position, std::vector<uint32_t> &ids, size_t limit = SIZE_MAX) const
+    {
+        ids.clear();
+        const GDBIndexEntry *entry = find(position.key());
+        if (!entry || entry->firstPosting > header.postingCount ||
+            entry->games > header.postingCount - entry->firstPosting)
+            return;
+        const uint32_t *first = column<uint32_t>(GDB_POSTINGS) + entry->firstPosting;
+        ids.assign(first, first + std::min<size_t>(entry->games, limit));
+    }
+
+    int result(uint32_t id) const
+    {
+        return column<uint8_t>(GDB_RESULTS)[id];
+    }
+
+    uint32_t plies(uint32_t id) const
+    {
+        return column<uint32_t>(GDB_PLIES)[id];
+    }
+
+    // Rebuild game id; false if the stored moves do not decode
+    bool game(uint32_t id, Game<N> &out) const
+    {
+        if (id >= header.gameCount || column<uint32_t>(GDB_START_IDS)[id] >= header.startCount)
+            return false;
+        const uint8_t *start = column<uint8_t>(GDB_STARTS) + size_t(column<uint32_t>(GDB_START_IDS)[id]) * (N * N + 1);
+        out = Game<N>(rules());
+        out.clear();
+        for (int i = 0; i < N * N; i++)
+        {
+            if (start[i] > 2)
+                return false;
+            out.set(i / N, i % N, start[i]);
+        }
+        out.setSideToMove(start[N * N] == 2 ? 2 : 1);
+
+        uint64_t offset = column<uint64_t>(GDB_MOVE_OFFSETS)[id];
+        const uint8_t *moves = column<uint8_t>(GDB_MOVES);
+        uint64_t bits = 0;
+        int available = 0;
+        MoveList<N> legal;
+        for (uint32_t ply = plies(id); ply > 0; ply--)
+        {
+            out.generateMoves(legal);
+            int width = codeBits(legal.size() + 1);
+            while (available < width)
+            {
+                if (offset >= header.moveBytes)
+                    return false;
+                bits |= uint64_t(moves[offset++]) << available;
+                available += 8;
+            }
+            int code = int(bits & ((uint64_t(1) << width) - 1));
+            bits >>= width;
+            available -= width;
+            if (code == legal.size())
+                out.passTurn();
+            else if (code < legal.size())
+                out.play(legal[code]);
+            else
+                return false;
+        }
+        return true;
+    }
+
+private:
+    MappedFile file;
+    GameDBHeader header;
+
+    template <typename T>
+    const T *column(GDBSection which) const
+    {
+        return reinterpret_cast<const T *>(file.data() + header.sections[which]);
+    }
+
+    const GDBIndexEntry *find(uint64_t key) const
+    {
+        const GDBIndexEntry *index = column<GDBIndexEntry>(GDB_INDEX);
+        const GDBIndexEntry *end = index + header.indexCount;
+        const GDBIndexEntry *entry =
+            std::lower_bound(index, end, key, [](const GDBIndexEntry &e, uint64_t k) { return e.key < k; });
+        return entry != end && entry->key == key ? entry : nullptr;
+    }
+
+    // Reject files for another grid or version, and sections that do not fit
+    bool validate()
+    {
+        if (file.size() < sizeof(GameDBHeader))
+            return false;
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != GDB_MAGIC || header.version != GDB_VERSION || header.size != N)
+            return false;
+        if (header.gameCount > file.size() || header.indexCount > file.size() || header.postingCount > file.size())
+            return false;
+        const uint64_t bytes[GDB_SECTIONS] = {uint64_t(header.startCount) * (N * N + 1),
+                                              header.gameCount,
+                                              header.gameCount * sizeof(uint32_t),
+                                              header.gameCount * sizeof(uint64_t),
+                                              header.gameCount * sizeof(uint32_t),
+                                              header.moveBytes,
+                                              header.indexCount * sizeof(GDBIndexEntry),
+                                              header.postingCount * sizeof(uint32_t)};
+        for (int s = 0; s < GDB_SECTIONS; s++)
+        {
+            if (header.sections[s] % 8 != 0 || header.sections[s] > file.size() ||
+                bytes[s] > file.size() - header.sections[s])
+                return false;
+        }
+        return true;
+    }
+};
+
+} // namespace bead
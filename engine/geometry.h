@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+
+namespace bead
+{
+
+// Per-cell move tables for an N x N grid, built at compile time.
+// A step reaches one of the eight neighbours; a jump travels two cells in a
+// straight or diagonal line, and the jumped cell is (from + to) / 2.
+template <int N>
+struct Geometry
+{
+    using Board = BitBoard<N>;
+    using Mask = typename Board::Mask;
+
+    static constexpr int CELLS = Board::CELLS;
+
+    struct Tables
+    {
+        Mask steps[CELLS] = {};
+        Mask jumps[CELLS] = {};
+        Mask diagonalJumps[CELLS] = {};
+        int8_t distance[CELLS][CELLS] = {};
+    };
+
+    // Integer form of the original calculateDistance:
+    // (int)sqrt(dr^2 + dc^2), except that a knight's offset counts as 3
+    static constexpr int legacyDistance(int dr, int dc)
+    {
+        int squared = dr * dr + dc * dc;
+        if (squared == 5)
+            return 3;
+        int root = 0;
+        while ((root + 1) * (root + 1) <= squared)
+            root++;
+        return root;
+    }
+
+    static constexpr Tables build()
+    {
+        Tables t{};
+        for (int from = 0; from < CELLS; from++)
+        {
+            Mask b = Board::bit(from);
+            for (int dir = 0; dir < DIRECTION_COUNT; dir++)
+            {
+                Mask step = Board::shift(b, dir);
+                Mask jump = Board::shift(step, dir);
+                t.steps[from] |= step;
+                t.jumps[from] |= jump;
+                if (DIAGONAL_DIRECTIONS & (1u << dir))
+                    t.diagonalJumps[from] |= jump;
+            }
+            for (int to = 0; to < CELLS; to++)
+            {
+                t.distance[from][to] = int8_t(legacyDistance(to / N - from / N, to % N - from % N));
+            }
+        }
+        return t;
+    }
+
+    static constexpr Tables TABLES = build();
+
+    // Exhaustive check over every (from, to) pair that the shift-built tables
+    // agree with the distance rule isMovable/isEdible used before them
+    static constexpr bool matchesLegacyRules()
+    {
+        for (int from = 0; from < CELLS; from++)
+        {
+            for (int to = 0; to < CELLS; to++)
+            {
+                int distance = TABLES.distance[from][to];
+                bool step = (TABLES.steps[from] >> to) & 1;
+                bool jump = (TABLES.jumps[from] >> to) & 1;
+                if (step != (distance == 1) || jump != (distance == 2))
+                    return false;
+
+                int midRow = (from / N + to / N) / 2;
+                int midCol = (from % N + to % N) / 2;
+                if (jump && (from + to) / 2 != midRow * N + midCol)
+                    return false;
+
+                int dr = to / N - from / N;
+                int dc = to % N - from % N;
+                bool diagonal = jump && dr != 0 && dc != 0;
+                if (diagonal != bool((TABLES.diagonalJumps[from] >> to) & 1))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(matchesLegacyRules(), "move tables disagree with the distance rule");
+
+    static constexpr bool isStep(int from, int to)
+    {
+        return (TABLES.steps[from] >> to) & 1;
+    }
+
+    // directions is ALL_DIRECTIONS or DIAGONAL_DIRECTIONS
+    static constexpr bool isJump(int from, int to, unsigned directions = ALL_DIRECTIONS)
+    {
+        const Mask *jumps = directions == DIAGONAL_DIRECTIONS ? TABLES.diagonalJumps : TABLES.jumps;
+        return (jumps[from] >> to) & 1;
+    }
+
+    static constexpr int middle(int from, int to)
+    {
+        return (from + to) / 2;
+    }
+};
+
+} // namespace bead
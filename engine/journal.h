@@ -0,0 +1,352 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "append_file.h"
+#include "game.h"
+#include "save_format.h"
+
+namespace bead
+{
+
+// Crash-safe record of the game in progress. The journal starts with a
+// snapshot of the game (a saved game, see save_format.h) and then grows by
+// one fixed-size record per move, written as the move is played. If the
+// program dies, recover() rebuilds the game from the snapshot and the
+// records that made it to the file.
+//
+// File layout, all little-endian:
+//   JournalHeader
+//   uint8_t snapshot[snapshotBytes]
+//   JournalRecord[...]        until the end of the file
+// A record carries the game's position key after its move, so a torn or
+// stale record at the end is recognised and dropped on recovery.
+//
+// Appending a record is one write() call on the caller's thread. Flushing
+// to the disk, which is much slower, happens on a background thread after
+// every syncEvery records or syncIntervalMs, whichever comes first. After
+// compactAfter records the background thread also writes a new snapshot
+// and swaps it in. The snapshot keeps the game's whole history, so that
+// recovery restores it too, at 3 bytes a move instead of a record's 16:
+// compaction slows the file's growth but does not stop it.
+
+const uint32_t JOURNAL_MAGIC = 0x314C4A42; // "BJL1"
+const uint16_t JOURNAL_VERSION = 1;
+
+struct JournalHeader
+{
+    uint32_t magic = JOURNAL_MAGIC;
+    uint16_t version = JOURNAL_VERSION;
+    uint16_t reserved = 0;
+    uint32_t snapshotBytes = 0;
+    uint32_t reserved2 = 0;
+};
+
+struct JournalRecord
+{
+    uint32_t ply = 0; // index of the move in the game's history
+    uint8_t from = 0;
+    uint8_t to = 0;
+    uint8_t flags = 0;
+    uint8_t reserved = 0;
+    uint64_t key = 0; // position key after the move
+};
+
+static_assert(sizeof(JournalHeader) == 16 && sizeof(JournalRecord) == 16, "journal records are stored as is");
+
+template <int N>
+class Journal
+{
+public:
+    explicit Journal(int syncEvery = 16, int syncIntervalMs = 250, uint32_t compactAfter = 512)
+        : syncEvery(syncEvery), syncInterval(syncIntervalMs), compactAfter(compactAfter)
+    {
+    }
+
+    ~Journal()
+    {
+        close();
+    }
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    // Rebuild the game a journal left behind; game keeps its rules and is
+    // only changed on success. replayed, if given, gets the number of moves
+    // taken from records rather than the snapshot.
+    static SaveStatus recover(const std::string &path, Game<N> &game, int *replayed = nullptr)
+    {
+        std::vector<uint8_t> bytes;
+        SaveStatus status = readFileBytes(path, bytes);
+        if (status != SAVE_OK)
+            return status;
+        JournalHeader header;
+        if (bytes.size() < sizeof(header))
+            return SAVE_TRUNCATED;
+        memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != JOURNAL_MAGIC)
+            return SAVE_BAD_MAGIC;
+        if (header.version != JOURNAL_VERSION)
+            return SAVE_BAD_VERSION;
+        if (header.snapshotBytes > bytes.size() - sizeof(header))
+            return SAVE_TRUNCATED;
+
+        Game<N> loaded(game.rules());
+        int timeRemainingMs = 0;
+        status = decodeSave(bytes.data() + sizeof(header), header.snapshotBytes, loaded, timeRemainingMs);
+        if (status != SAVE_OK)
+            return status;
+
+        // Replay records up to the first one that is cut short or does not
+        // fit, leaving out the jumps of a capture chain the crash cut short
+        size_t records = sizeof(header) + header.snapshotBytes;
+        int complete = 0;
+        int count = replayRecords(bytes, records, INT32_MAX, loaded, complete);
+        if (complete < count)
+        {
+            loaded = Game<N>(game.rules());
+            decodeSave(bytes.data() + sizeof(header), header.snapshotBytes, loaded, timeRemainingMs);
+            count = replayRecords(bytes, records, complete, loaded, complete);
+        }
+
+        game = loaded;
+        if (replayed)
+            *replayed = count;
+        return SAVE_OK;
+    }
+
+    // Start journalling game at path, replacing any journal there
+    bool start(const std::string &path, const Game<N> &game)
+    {
+        close();
+        filePath = path;
+        if (!writeSnapshot(filePath + ".tmp", game) || !AppendFile::replace(filePath + ".tmp", filePath) ||
+            !file.open(filePath, false))
+        {
+            std::remove((filePath + ".tmp").c_str());
+            return false;
+        }
+        tracked = game.position();
+        written = game.history().size();
+        sinceSnapshot = 0;
+        stopping = false;
+        syncer = std::thread([this] { run(); });
+        return true;
+    }
+
+    // Append the moves game has played since the last call. Call it after
+    // every move, or once per frame; a game that was reset or loaded since
+    // gets a fresh journal.
+    void record(const Game<N> &game)
+    {
+        if (!isOpen())
+            return;
+        const std::vector<Move> &history = game.history();
+        if (history.size() == written && game.position().key() == tracked.key())
+            return;
+
+        JournalRecord records[16];
+        size_t count = 0;
+        Position<N> position = tracked;
+        for (size_t ply = written; ply < history.size() && count < 16; ply++, count++)
+        {
+            const Move &move = history[ply];
+            if (move.isPass())
+                position.passTurn();
+            else
+                position.make(move);
+            records[count] = JournalRecord{uint32_t(ply), move.from, move.to, move.flags, 0, position.key()};
+        }
+        if (history.size() < written || written + count != history.size() ||
+            position.key() != game.position().key())
+        {
+            start(filePath, game); // not the game we were following
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (!file.write(records, count * sizeof(JournalRecord)))
+            return;
+        tracked = position;
+        written = history.size();
+        unsynced += uint32_t(count);
+        sinceSnapshot += uint32_t(count);
+        if (compacting)
+            tail.insert(tail.end(), records, records + count);
+        else if (sinceSnapshot >= compactAfter)
+        {
+            compacting = true;
+            snapshot = encodeSnapshot(game);
+            tail.clear();
+        }
+        if (unsynced >= uint32_t(syncEvery) || (compacting && !snapshot.empty()))
+            wake.notify_one();
+    }
+
+    // Flush what was written to the disk and stop; the file stays
+    void close()
+    {
+        if (!syncer.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        syncer.join();
+        file.close();
+        compacting = false;
+        snapshot.clear();
+        tail.clear();
+    }
+
+    // Stop and delete the journal, for a game that is over or abandoned
+    void discard()
+    {
+        close();
+        if (!filePath.empty())
+            std::remove(filePath.c_str());
+    }
+
+    bool isOpen() const
+    {
+        return syncer.joinable();
+    }
+
+private:
+    int syncEvery;
+    std::chrono::milliseconds syncInterval;
+    uint32_t compactAfter;
+
+    std::string filePath;
+    AppendFile file;
+    Position<N> tracked;  // position after the last journalled move
+    size_t written = 0;   // moves of the game's history in the journal
+
+    std::mutex lock;      // guards the members below and writes to file
+    std::condition_variable wake;
+    std::thread syncer;
+    bool stopping = false;
+    uint32_t unsynced = 0;
+    uint32_t sinceSnapshot = 0;
+    bool compacting = false;
+    std::vector<uint8_t> snapshot;     // new file contents, waiting to be written
+    std::vector<JournalRecord> tail;   // records written during compaction
+
+    // Replay at most limit records from offset on; complete gets how many
+    // of them end a turn, so none of its capture chain is missing
+    static int replayRecords(const std::vector<uint8_t> &bytes, size_t offset, int limit, Game<N> &loaded,
+                             int &complete)
+    {
+        int count = 0;
+        for (; count < limit && offset + sizeof(JournalRecord) <= bytes.size();
+             offset += sizeof(JournalRecord), count++)
+        {
+            JournalRecord record;
+            memcpy(&record, bytes.data() + offset, sizeof(record));
+            if (record.ply != loaded.history().size() || !matches(loaded.position(), record) ||
+                !replayMove(loaded, Move{record.from, record.to, record.flags}))
+                break;
+            if (!loaded.history().back().continues())
+                complete = count + 1;
+        }
+        return count;
+    }
+
+    // The record's key is that of position after the record's move
+    static bool matches(Position<N> position, const JournalRecord &record)
+    {
+        Move move{record.from, record.to, record.flags};
+        if (move.isPass())
+            position.passTurn();
+        else if (move.from < N * N && move.to < N * N)
+            position.make(move); // legality is checked when the move is replayed
+        else
+            return false;
+        return position.key() == record.key;
+    }
+
+    static std::vector<uint8_t> encodeSnapshot(const Game<N> &game)
+    {
+        std::vector<uint8_t> save = encodeSave(game, 0);
+        JournalHeader header;
+        header.snapshotBytes = uint32_t(save.size());
+        std::vector<uint8_t> bytes(sizeof(header) + save.size());
+        memcpy(bytes.data(), &header, sizeof(header));
+        memcpy(bytes.data() + sizeof(header), save.data(), save.size());
+        return bytes;
+    }
+
+    static bool writeSnapshot(const std::string &path, const Game<N> &game)
+    {
+        std::vector<uint8_t> bytes = encodeSnapshot(game);
+        AppendFile out;
+        return out.open(path, true) && out.write(bytes.data(), bytes.size()) && out.sync();
+    }
+
+    // Background thread: batched flushes and compaction
+    void run()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true)
+        {
+            wake.wait_for(guard, syncInterval, [this] {
+                return stopping || unsynced >= uint32_t(syncEvery) || (compacting && !snapshot.empty());
+            });
+
+            if (compacting && !snapshot.empty() && !stopping)
+                compact(guard);
+
+            if (unsynced > 0)
+            {
+                unsynced = 0;
+                guard.unlock();
+                file.sync(); // the file is only reopened on this thread, so no lock is needed
+                guard.lock();
+            }
+            if (stopping)
+                return;
+        }
+    }
+
+    // Write the new snapshot beside the journal, add the records played
+    // meanwhile and swap it in. Until the swap, records still go to the old
+    // file, which therefore stays complete if anything fails.
+    void compact(std::unique_lock<std::mutex> &guard)
+    {
+        std::vector<uint8_t> bytes;
+        bytes.swap(snapshot);
+        std::string tmpPath = filePath + ".tmp";
+        guard.unlock();
+        AppendFile out;
+        bool ok = out.open(tmpPath, true) && out.write(bytes.data(), bytes.size()) && out.sync();
+        guard.lock();
+
+        ok = ok && out.write(tail.data(), tail.size() * sizeof(JournalRecord));
+        out.close();
+        if (ok)
+        {
+            file.close();
+            ok = AppendFile::replace(tmpPath, filePath);
+            file.open(filePath, false); // the new file, or the old one if the swap failed
+        }
+        if (ok)
+        {
+            unsynced = uint32_t(tail.size());
+            sinceSnapshot = uint32_t(tail.size());
+        }
+        else
+            std::remove(tmpPath.c_str());
+        tail.clear();
+        compacting = false;
+    }
+};
+
+} // namespace bead
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+#include "geometry.h"
+
+namespace bead
+{
+
+const uint8_t MOVE_CAPTURE = 1;
+const uint8_t MOVE_PASS = 2; // a turn given up without moving; only in game records
+const uint8_t MOVE_CONTINUES = 4; // a jump the same bead follows with another; the turn does not pass
+
+struct Move
+{
+    uint8_t from = 0;
+    uint8_t to = 0;
+    uint8_t flags = 0;
+
+    bool isCapture() const
+    {
+        return flags & MOVE_CAPTURE;
+    }
+
+    bool isPass() const
+    {
+        return flags & MOVE_PASS;
+    }
+
+    bool continues() const
+    {
+        return flags & MOVE_CONTINUES;
+    }
+
+    bool operator==(const Move &other) const
+    {
+        return from == other.from && to == other.to && flags == other.flags;
+    }
+
+    bool operator!=(const Move &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Fixed-capacity move list meant to live on the stack. Captures are stored
+// first, so moves[0 .. captures) are jumps and the rest are simple moves.
+template <int N>
+struct MoveList
+{
+    // Each direction gives a bead at most one move (a step or a jump), and
+    // at least one cell must be empty for any move to exist
+    static constexpr int CAPACITY = (N * N - 1) * DIRECTION_COUNT;
+
+    Move moves[CAPACITY];
+    int count = 0;
+    int captures = 0;
+
+    void clear()
+    {
+        count = 0;
+        captures = 0;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    Move &operator[](int i)
+    {
+        return moves[i];
+    }
+
+    const Move &operator[](int i) const
+    {
+        return moves[i];
+    }
+
+    Move *begin()
+    {
+        return moves;
+    }
+
+    Move *end()
+    {
+        return moves + count;
+    }
+
+    const Move *begin() const
+    {
+        return moves;
+    }
+
+    const Move *end() const
+    {
+        return moves + count;
+    }
+
+    // Index of the move from -> to, or -1 when it is not in the list
+    int find(int from, int to) const
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (moves[i].from == from && moves[i].to == to)
+                return i;
+        }
+        return -1;
+    }
+};
+
+// Write every legal move for player into list, captures first.
+// Moves are produced per direction by shifting the player's mask, so the
+// cost depends on the number of moves, not on the number of cells. The
+// direction loops are unrolled, with each shift a constant of the grid size.
+template <int N>
+void generateMoves(const BitBoard<N> &board, int player, MoveList<N> &list,
+                   unsigned jumpDirections = ALL_DIRECTIONS)
+{
+    using Board = BitBoard<N>;
+    using Mask = typename Board::Mask;
+
+    list.clear();
+    Mask own = board.own(player);
+    Mask prey = board.opponent(player);
+    Mask empty = board.empty();
+
+    forEachDirection([&](auto dir) {
+        if (!(jumpDirections & (1u << dir)))
+            return;
+        Mask targets = Board::shift(Board::shift(own, dir) & prey, dir) & empty;
+        constexpr int back = 2 * Board::offset(dir);
+        while (targets)
+        {
+            int to = lowestBit(targets);
+            targets &= targets - 1;
+            list.moves[list.count++] = Move{uint8_t(to - back), uint8_t(to), MOVE_CAPTURE};
+        }
+    });
+    list.captures = list.count;
+
+    forEachDirection([&](auto dir) {
+        Mask targets = Board::shift(own, dir) & empty;
+        constexpr int back = Board::offset(dir);
+        while (targets)
+        {
+            int to = lowestBit(targets);
+            targets &= targets - 1;
+            list.moves[list.count++] = Move{uint8_t(to - back), uint8_t(to), 0};
+        }
+    });
+}
+
+// Play a move from generateMoves for player
+template <int N>
+void applyMove(BitBoard<N> &board, int player, Move move)
+{
+    board.beads[player - 1] ^= BitBoard<N>::bit(move.from) | BitBoard<N>::bit(move.to);
+    if (move.isCapture())
+        board.beads[2 - player] &= ~BitBoard<N>::bit(Geometry<N>::middle(move.from, move.to));
+}
+
+// Take back a move played with applyMove
+template <int N>
+void undoMove(BitBoard<N> &board, int player, Move move)
+{
+    board.beads[player - 1] ^= BitBoard<N>::bit(move.from) | BitBoard<N>::bit(move.to);
+    if (move.isCapture())
+        board.beads[2 - player] |= BitBoard<N>::bit(Geometry<N>::middle(move.from, move.to));
+}
+
+// The original computer policy: a random capture if there is one,
+// otherwise a random simple move. list must not be empty.
+template <int N>
+Move randomMove(const MoveList<N> &list, unsigned random)
+{
+    if (list.captures > 0)
+        return list.moves[random % list.captures];
+    return list.moves[random % list.count];
+}
+
+} // namespace bead
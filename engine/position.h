@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+#include "geometry.h"
+#include "movegen.h"
+#include "zobrist.h"
+
+namespace bead
+{
+
+const int NO_SQUARE = -1;
+
+// What make() changed that the move itself does not record
+struct Undo
+{
+    uint64_t key = 0;
+    int8_t captured = NO_SQUARE; // square of the captured bead
+};
+
+// A game position: beads, side to move, Zobrist key and bead counts.
+// make/unmake update it in place, so searching or replaying never copies
+// the board, and any number of positions can live side by side.
+template <int N>
+class Position
+{
+public:
+    using Board = BitBoard<N>;
+    using Keys = Zobrist<N>;
+
+    Position()
+    {
+        hashKey = Keys::key(board, player);
+    }
+
+    const Board &bitboard() const
+    {
+        return board;
+    }
+
+    int sideToMove() const
+    {
+        return player;
+    }
+
+    uint64_t key() const
+    {
+        return hashKey;
+    }
+
+    int at(int row, int col) const
+    {
+        return board.at(row, col);
+    }
+
+    // Beads player p has left; kept up to date, not counted
+    int count(int p) const
+    {
+        return beads[p - 1];
+    }
+
+    void set(int row, int col, int p)
+    {
+        int sq = Board::square(row, col);
+        int old = board.at(row, col);
+        if (old != 0)
+        {
+            hashKey ^= Keys::KEYS.bead[old - 1][sq];
+            beads[old - 1]--;
+        }
+        board.set(row, col, p);
+        if (p == 1 || p == 2)
+        {
+            hashKey ^= Keys::KEYS.bead[p - 1][sq];
+            beads[p - 1]++;
+        }
+    }
+
+    void clear()
+    {
+        board.clear();
+        beads[0] = beads[1] = 0;
+        player = 1;
+        hashKey = Keys::key(board, player);
+    }
+
+    void setSideToMove(int p)
+    {
+        if (p != player)
+            passTurn();
+    }
+
+    // Hand the turn over without moving (used when a turn times out)
+    void passTurn()
+    {
+        player = 3 - player;
+        hashKey ^= Keys::KEYS.side;
+    }
+
+    // Play a legal move for the side to move. The turn passes unless the
+    // move is a jump that continues a capture chain.
+    Undo make(Move move)
+    {
+        Undo undo;
+        undo.key = hashKey;
+        hashKey ^= Keys::moveDelta(player, move);
+        board.beads[player - 1] ^= Board::bit(move.from) | Board::bit(move.to);
+        if (move.isCapture())
+        {
+            undo.captured = int8_t(Geometry<N>::middle(move.from, move.to));
+            board.beads[2 - player] &= ~Board::bit(undo.captured);
+            beads[2 - player]--;
+        }
+        if (!move.continues())
+            player = 3 - player;
+        return undo;
+    }
+
+    // Take back the last move played with make
+    void unmake(Move move, const Undo &undo)
+    {
+        if (!move.continues())
+            player = 3 - player;
+        board.beads[player - 1] ^= Board::bit(move.from) | Board::bit(move.to);
+        if (undo.captured != NO_SQUARE)
+        {
+            board.beads[2 - player] |= Board::bit(undo.captured);
+            beads[2 - player]++;
+        }
+        hashKey = undo.key;
+    }
+
+    void generateMoves(MoveList<N> &list, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        bead::generateMoves(board, player, list, jumpDirections);
+    }
+
+    bool hasMoves(int p, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        return board.hasMoves(p, jumpDirections);
+    }
+
+    int moveCount(int p, unsigned jumpDirections = ALL_DIRECTIONS) const
+    {
+        return board.moveCount(p, jumpDirections);
+    }
+
+private:
+    Board board;
+    int player = 1;
+    uint8_t beads[2] = {0, 0}; // per player, matching the board; fits beside player
+    uint64_t hashKey = 0;
+};
+
+} // namespace bead
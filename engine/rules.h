@@ -0,0 +1,21 @@
+#pragma once
+
+#include "bitboard.h"
+
+namespace bead
+{
+
+// Rule options that differ between game variants
+struct Rules
+{
+    // Directions a capturing jump may take. The 6x6 game allows all eight;
+    // the 4x4 console game only jumps diagonally.
+    unsigned jumpDirections = ALL_DIRECTIONS;
+
+    // A bead that has captured may jump again, as often as it can, in the
+    // same turn (see chains.h). Off in both front ends. The search still
+    // plays single jumps, which stay legal turns, and looks no further.
+    bool captureChains = false;
+};
+
+} // namespace bead
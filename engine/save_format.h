@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "game.h"
+
+namespace bead
+{
+
+// Saved games. A save holds everything needed to resume: the position the
+// game's history starts from, every move since (passes included), the side
+// to move and the time left on the current turn. Loading replays the moves,
+// so a file that decodes is also a legal game.
+//
+// File layout, all little-endian:
+//   SaveHeader
+//   uint8_t cells[N * N]      start position, row by row: 0, 1 or 2
+//   moves[moveCount]          3 bytes each: from, to, flags; a capture
+//                             chain is stored one jump at a time
+//   uint32_t checksum         CRC-32 of everything before it
+// The whole file is read in one call and checked before the game is
+// touched, so a short, corrupt or foreign file leaves the game unchanged.
+
+const uint32_t SAVE_MAGIC = 0x31565342; // "BSV1"
+const uint16_t SAVE_VERSION = 1;
+
+struct SaveHeader
+{
+    uint32_t magic = SAVE_MAGIC;
+    uint16_t version = SAVE_VERSION;
+    uint8_t size = 0;       // grid size N
+    uint8_t sideToMove = 0; // after the last move
+    uint32_t jumpDirections = 0;
+    int32_t timeRemainingMs = 0; // on the side to move's turn clock
+    uint32_t moveCount = 0;
+    uint8_t startSide = 0;  // to move in the start position
+    uint8_t captureChains = 0; // Rules::captureChains; zero in saves from before it
+    uint8_t reserved[2] = {};
+};
+
+static_assert(sizeof(SaveHeader) == 24, "save headers are stored as is");
+
+enum SaveStatus
+{
+    SAVE_OK,
+    SAVE_NOT_FOUND,
+    SAVE_IO_ERROR,
+    SAVE_BAD_MAGIC,
+    SAVE_BAD_VERSION,
+    SAVE_WRONG_SIZE,  // saved from a game on another grid
+    SAVE_WRONG_RULES, // saved from a game with other jump rules
+    SAVE_TRUNCATED,
+    SAVE_BAD_CHECKSUM,
+    SAVE_BAD_GAME // checksum fine, but the contents are not a legal game
+};
+
+inline const char *saveStatusText(SaveStatus status)
+{
+    switch (status)
+    {
+    case SAVE_OK:
+        return "ok";
+    case SAVE_NOT_FOUND:
+        return "file not found";
+    case SAVE_IO_ERROR:
+        return "read or write error";
+    case SAVE_BAD_MAGIC:
+        return "not a saved game";
+    case SAVE_BAD_VERSION:
+        return "saved by a newer version";
+    case SAVE_WRONG_SIZE:
+        return "saved from a different grid size";
+    case SAVE_WRONG_RULES:
+        return "saved from a game with different rules";
+    case SAVE_TRUNCATED:
+        return "file is truncated";
+    case SAVE_BAD_CHECKSUM:
+        return "file is corrupt";
+    case SAVE_BAD_GAME:
+        return "file does not hold a legal game";
+    }
+    return "unknown error";
+}
+
+struct Crc32
+{
+    uint32_t table[256] = {};
+};
+
+constexpr Crc32 buildCrc32()
+{
+    Crc32 crc{};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crc.table[i] = c;
+    }
+    return crc;
+}
+
+constexpr Crc32 CRC32 = buildCrc32();
+
+inline uint32_t crc32(const uint8_t *data, size_t length)
+{
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++)
+        c = CRC32.table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Bytes of a save holding moveCount moves, checksum included
+template <int N>
+size_t saveFileSize(uint32_t moveCount)
+{
+    return sizeof(SaveHeader) + N * N + size_t(moveCount) * 3 + sizeof(uint32_t);
+}
+
+template <int N>
+std::vector<uint8_t> encodeSave(const Game<N> &game, int timeRemainingMs)
+{
+    const Position<N> &start = game.startPosition();
+    const std::vector<Move> &moves = game.history();
+
+    SaveHeader header;
+    header.size = N;
+    header.sideToMove = uint8_t(game.sideToMove());
+    header.jumpDirections = game.rules().jumpDirections;
+    header.timeRemainingMs = timeRemainingMs;
+    header.moveCount = uint32_t(moves.size());
+    header.startSide = uint8_t(start.sideToMove());
+    header.captureChains = game.rules().captureChains;
+
+    std::vector<uint8_t> bytes(saveFileSize<N>(header.moveCount));
+    uint8_t *out = bytes.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+            *out++ = uint8_t(start.at(i, j));
+    }
+    for (const Move &move : moves)
+    {
+        *out++ = move.from;
+        *out++ = move.to;
+        *out++ = move.flags;
+    }
+    uint32_t checksum = crc32(bytes.data(), size_t(out - bytes.data()));
+    memcpy(out, &checksum, sizeof(checksum));
+    return bytes;
+}
+
+// Play a recorded move or pass; false if it is not legal in game
+template <int N>
+bool replayMove(Game<N> &game, const Move &move)
+{
+    // Inside a capture chain only the bead that jumped last moves, by jumping
+    const std::vector<Move> &history = game.history();
+    if (!history.empty() && history.back().continues() && (!move.isCapture() || move.from != history.back().to))
+        return false;
+    if (move.continues() && (!move.isCapture() || !game.rules().captureChains))
+        return false;
+
+    if (move.isPass())
+    {
+        if (move.from != 0 || move.to != 0 || move.flags != MOVE_PASS)
+            return false;
+        game.passTurn();
+        return true;
+    }
+    MoveList<N> legal;
+    game.generateMoves(legal);
+    int index = legal.find(move.from, move.to);
+    if (index < 0 || legal[index].flags != (move.flags & ~MOVE_CONTINUES))
+        return false;
+    game.play(move);
+    return true;
+}
+
+// Decode a save into game, which keeps its rules; game is only changed
+// when the whole save is valid
+template <int N>
+SaveStatus decodeSave(const uint8_t *data, size_t length, Game<N> &game, int &timeRemainingMs)
+{
+    SaveHeader header;
+    if (length < sizeof(header))
+        return SAVE_TRUNCATED;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SAVE_MAGIC)
+        return SAVE_BAD_MAGIC;
+    if (header.version != SAVE_VERSION)
+        return SAVE_BAD_VERSION;
+    if (header.size != N)
+        return SAVE_WRONG_SIZE;
+    if (header.jumpDirections != game.rules().jumpDirections || header.captureChains != game.rules().captureChains)
+        return SAVE_WRONG_RULES;
+    if (length != saveFileSize<N>(header.moveCount))
+        return length < saveFileSize<N>(header.moveCount) ? SAVE_TRUNCATED : SAVE_BAD_CHECKSUM;
+    uint32_t checksum;
+    memcpy(&checksum, data + length - sizeof(checksum), sizeof(checksum));
+    if (checksum != crc32(data, length - sizeof(checksum)))
+        return SAVE_BAD_CHECKSUM;
+    if ((header.startSide != 1 && header.startSide != 2) || (header.sideToMove != 1 && header.sideToMove != 2))
+        return SAVE_BAD_GAME;
+
+    Game<N> loaded(game.rules());
+    loaded.clear();
+    const uint8_t *in = data + sizeof(header);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++, in++)
+        {
+            if (*in > 2)
+                return SAVE_BAD_GAME;
+            loaded.set(i, j, *in);
+        }
+    }
+    loaded.setSideToMove(header.startSide);
+
+    // Replay the history, accepting only legal moves
+    for (uint32_t m = 0; m < header.moveCount; m++, in += 3)
+    {
+        if (!replayMove(loaded, Move{in[0], in[1], in[2]}))
+            return SAVE_BAD_GAME;
+    }
+    if (!loaded.history().empty() && loaded.history().back().continues())
+        return SAVE_BAD_GAME; // ends inside a capture chain
+    if (loaded.sideToMove() != header.sideToMove)
+        return SAVE_BAD_GAME;
+
+    game = loaded;
+    timeRemainingMs = header.timeRemainingMs;
+    return SAVE_OK;
+}
+
+template <int N>
+SaveStatus writeSaveFile(const std::string &path, const Game<N> &game, int timeRemainingMs)
+{
+    std::vector<uint8_t> bytes = encodeSave(game, timeRemainingMs);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return SAVE_IO_ERROR;
+    file.write(reinterpret_cast<const char *>(bytes.data()), std::streamsize(bytes.size()));
+    return file ? SAVE_OK : SAVE_IO_ERROR;
+}
+
+// Read a whole file in one call
+inline SaveStatus readFileBytes(const std::string &path, std::vector<uint8_t> &bytes)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return SAVE_NOT_FOUND;
+    std::streamoff length = file.tellg();
+    if (length < 0)
+        return SAVE_IO_ERROR;
+    bytes.resize(size_t(length));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(bytes.data()), length))
+        return SAVE_IO_ERROR;
+    return SAVE_OK;
+}
+
+template <int N>
+SaveStatus readSaveFile(const std::string &path, Game<N> &game, int &timeRemainingMs)
+{
+    std::vector<uint8_t> bytes;
+    SaveStatus status = readFileBytes(path, bytes);
+    if (status != SAVE_OK)
+        return status;
+    return decodeSave(bytes.data(), bytes.size(), game, timeRemainingMs);
+}
+
+} // namespace bead
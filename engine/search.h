@@ -0,0 +1,509 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "bitboard.h"
+#include "eval.h"
+#include "movegen.h"
+#include "position.h"
+#include "rules.h"
+#include "tablebase.h"
+#include "tt.h"
+
+namespace bead
+{
+
+const int SCORE_WIN = 30000;
+const int SCORE_INFINITE = 32000;
+const int MAX_PLY = 64;
+
+// Scores beyond this are wins or losses in a known number of plies
+const int SCORE_WIN_BOUND = SCORE_WIN - MAX_PLY;
+
+// Budget for one search. Zero means no limit for that resource. maxNodes
+// counts the nodes of all search threads together.
+struct SearchLimits
+{
+    int maxDepth = MAX_PLY;
+    uint64_t maxNodes = 0;
+    int timeMs = 0;
+};
+
+struct SearchResult
+{
+    Move best;
+    bool hasMove = false;
+    int score = 0;
+    int depth = 0;       // last fully searched depth
+    uint64_t nodes = 0;
+    double seconds = 0;
+    TTStats tt;
+
+    uint64_t nodesPerSecond() const
+    {
+        return seconds > 0 ? uint64_t(nodes / seconds) : nodes;
+    }
+};
+
+// Win and loss scores are stored relative to the node, not the root
+inline int scoreToTT(int score, int ply)
+{
+    if (score >= SCORE_WIN_BOUND)
+        return score + ply;
+    if (score <= -SCORE_WIN_BOUND)
+        return score - ply;
+    return score;
+}
+
+inline int scoreFromTT(int score, int ply)
+{
+    if (score >= SCORE_WIN_BOUND)
+        return score - ply;
+    if (score <= -SCORE_WIN_BOUND)
+        return score + ply;
+    return score;
+}
+
+// Iterative-deepening negamax with alpha-beta pruning and a transposition
+// table. The hash move is tried first, then captures, then killer moves,
+// then quiet moves by history score.
+// A Searcher keeps its table and heuristics between calls, so reuse one per player.
+//
+// With more than one thread the search is Lazy SMP: every thread runs the
+// same iterative deepening on its own copy of the position and its own
+// move-ordering tables, and they share only the lock-free transposition
+// table. Helper threads start one depth ahead on odd indices, so the
+// threads drift apart and fill the table with results the main thread
+// then picks up. One thread (the default) is fully deterministic.
+template <int N>
+class Searcher
+{
+public:
+    explicit Searcher(size_t hashMB = 16)
+        : tt(hashMB)
+    {
+        setThreads(1);
+    }
+
+    void setHashSize(size_t hashMB)
+    {
+        tt.resize(hashMB);
+    }
+
+    // Number of search threads; 0 uses every hardware thread
+    void setThreads(int count)
+    {
+        if (count <= 0)
+            count = std::max(1u, std::thread::hardware_concurrency());
+        while (int(workers.size()) > count)
+            workers.pop_back();
+        while (int(workers.size()) < count)
+            workers.emplace_back(new Worker(*this, int(workers.size())));
+    }
+
+    int threads() const
+    {
+        return int(workers.size());
+    }
+
+    // Exact endgame results for positions the table covers; null for none.
+    // The table must stay open while the searcher uses it.
+    void setTablebase(const Tablebase<N> *tablebase)
+    {
+        this->tablebase = tablebase;
+    }
+
+    // Weights of the static evaluation at the leaves. Clears the table,
+    // whose scores came from the old weights.
+    void setEvalWeights(const EvalWeights &weights)
+    {
+        evaluator.setWeights(weights);
+        tt.clear();
+    }
+
+    const EvalWeights &evalWeights() const
+    {
+        return evaluator.getWeights();
+    }
+
+    // Ask a running search to finish now with its best move so far. Safe to
+    // call from any thread; a search that has not started yet ignores it.
+    void stopSearch()
+    {
+        stop = true;
+    }
+
+    void clearHistory()
+    {
+        for (auto &worker : workers)
+            worker->clearHistory();
+        tt.clear();
+    }
+
+    SearchResult search(const Position<N> &root, const SearchLimits &limits, const Rules &rules = Rules())
+    {
+        // Stored results are only valid under the rules that produced them
+        if (rules.jumpDirections != this->rules.jumpDirections)
+            tt.clear();
+        this->rules = rules;
+        this->limits = limits;
+        startTime = std::chrono::steady_clock::now();
+        stop = false;
+        searchedNodes = 0;
+        tt.newSearch();
+
+        std::vector<SearchResult> results(workers.size());
+        std::vector<std::thread> helpers;
+        for (size_t i = 1; i < workers.size(); i++)
+            helpers.emplace_back([this, &root, &results, i] { workers[i]->run(root, results[i]); });
+        workers[0]->run(root, results[0]);
+        stop = true;
+        for (std::thread &helper : helpers)
+            helper.join();
+
+        // The deepest completed iteration wins; the main thread breaks ties
+        SearchResult result = results[0];
+        for (size_t i = 1; i < results.size(); i++)
+        {
+            if (results[i].hasMove && results[i].depth > result.depth)
+            {
+                result.best = results[i].best;
+                result.score = results[i].score;
+                result.depth = results[i].depth;
+            }
+        }
+        result.nodes = 0;
+        result.tt = TTStats();
+        for (const SearchResult &part : results)
+        {
+            result.nodes += part.nodes;
+            result.tt.probes += part.tt.probes;
+            result.tt.hits += part.tt.hits;
+            result.tt.stores += part.tt.stores;
+            result.tt.tbHits += part.tt.tbHits;
+        }
+        result.seconds = elapsedSeconds();
+        return result;
+    }
+
+private:
+    // One search thread's state; everything here is private to its thread
+    class Worker
+    {
+    public:
+        Worker(Searcher &owner, int index)
+            : owner(owner), index(index)
+        {
+            clearHistory();
+        }
+
+        void clearHistory()
+        {
+            memset(killers, 0, sizeof(killers));
+            memset(history, 0, sizeof(history));
+        }
+
+        void run(const Position<N> &root, SearchResult &result)
+        {
+            const Rules &rules = owner.rules;
+            nodes = 0;
+            reportedNodes = 0;
+            stats = TTStats();
+            ageHistory();
+
+            position = root;
+            int player = root.sideToMove();
+
+            MoveList<N> rootMoves;
+            position.generateMoves(rootMoves, rules.jumpDirections);
+            if (rootMoves.empty())
+            {
+                result.score = -SCORE_WIN;
+                return;
+            }
+            result.best = rootMoves[0];
+            result.hasMove = true;
+
+            const SearchLimits &limits = owner.limits;
+            int maxDepth = limits.maxDepth > 0 && limits.maxDepth < MAX_PLY ? limits.maxDepth : MAX_PLY - 1;
+            for (int depth = 1 + index % 2; depth <= maxDepth; depth++)
+            {
+                int alpha = -SCORE_INFINITE;
+                int beta = SCORE_INFINITE;
+                Move iterationBest = result.best;
+                int *moveScores = scoreMoves(rootMoves, player, 0, result.best);
+
+                for (int i = 0; i < rootMoves.size(); i++)
+                {
+                    pickNext(rootMoves, i, moveScores);
+                    Move move = rootMoves[i];
+                    Undo undo = position.make(move);
+                    int score = -negamax(depth - 1, -beta, -alpha, 1);
+                    position.unmake(move, undo);
+                    if (stopped())
+                        break;
+                    if (score > alpha)
+                    {
+                        alpha = score;
+                        iterationBest = move;
+                    }
+                }
+                if (stopped())
+                    break;
+
+                result.best = iterationBest;
+                result.score = alpha;
+                result.depth = depth;
+
+                // A forced result will not change with more depth
+                if (alpha >= SCORE_WIN_BOUND || alpha <= -SCORE_WIN_BOUND)
+                    break;
+            }
+
+            result.nodes = nodes;
+            result.tt = stats;
+        }
+
+    private:
+        Searcher &owner;
+        int index; // 0 is the main thread, which alone checks the clock
+        uint64_t nodes = 0;
+        uint64_t reportedNodes = 0; // part of nodes added to owner.searchedNodes
+        TTStats stats;
+
+        // Position being searched, updated in place by make/unmake
+        Position<N> position;
+
+        Move killers[MAX_PLY][2];
+        int history[2][N * N][N * N];
+        int scoreBuffer[MAX_PLY][MoveList<N>::CAPACITY]; // move ordering scores per ply
+
+        // History scores stay below the killer bonus
+        static const int HISTORY_MAX = 1 << 28;
+
+        // Halve history scores so old searches count for less
+        void ageHistory()
+        {
+            for (auto &side : history)
+                for (auto &from : side)
+                    for (int &entry : from)
+                        entry /= 2;
+        }
+
+        bool stopped() const
+        {
+            return owner.stop.load(std::memory_order_relaxed);
+        }
+
+        // Threads add their nodes to the shared total in batches, so a
+        // search with T threads may pass maxNodes by up to T * NODE_BATCH
+        static const uint64_t NODE_BATCH = 64;
+
+        void checkLimits()
+        {
+            const SearchLimits &limits = owner.limits;
+            if (limits.maxNodes)
+            {
+                uint64_t pending = nodes - reportedNodes;
+                if (pending >= NODE_BATCH)
+                {
+                    owner.searchedNodes.fetch_add(pending, std::memory_order_relaxed);
+                    reportedNodes = nodes;
+                    pending = 0;
+                }
+                if (owner.searchedNodes.load(std::memory_order_relaxed) + pending >= limits.maxNodes)
+                    owner.stop = true;
+            }
+            if (index != 0)
+                return;
+            if (limits.timeMs && (nodes & 1023) == 0 && owner.elapsedSeconds() * 1000 >= limits.timeMs)
+                owner.stop = true;
+        }
+
+        bool probe(uint64_t key, TTEntry &entry)
+        {
+            stats.probes++;
+            if (!owner.tt.probe(key, entry))
+                return false;
+            stats.hits++;
+            return true;
+        }
+
+        void store(uint64_t key, int depth, int score, Bound bound, Move move)
+        {
+            stats.stores++;
+            owner.tt.store(key, depth, score, bound, move);
+        }
+
+        // Kept inside the win bounds, so that no weights can make a static
+        // score pass for a forced result or overflow a table entry
+        int evaluate(int player) const
+        {
+            int score = owner.evaluator.evaluate(position.bitboard(), player, owner.rules.jumpDirections);
+            return std::clamp(score, -(SCORE_WIN_BOUND - 1), SCORE_WIN_BOUND - 1);
+        }
+
+        int negamax(int depth, int alpha, int beta, int ply)
+        {
+            nodes++;
+            checkLimits();
+            if (stopped())
+                return 0;
+
+            // No beads, or no way to move them, loses the game
+            const Rules &rules = owner.rules;
+            int player = position.sideToMove();
+            if (position.count(player) == 0)
+                return -SCORE_WIN + ply;
+
+            // Endgames in the tablebase are known exactly
+            TBResult known;
+            const Tablebase<N> *tablebase = owner.tablebase;
+            if (tablebase && tablebase->covers(position.bitboard(), rules) &&
+                tablebase->probe(position.bitboard(), player, known))
+            {
+                stats.tbHits++;
+                if (known.value == TB_WIN)
+                    return SCORE_WIN - ply - known.distance;
+                if (known.value == TB_LOSS)
+                    return -SCORE_WIN + ply + known.distance;
+                return 0;
+            }
+
+            if (depth <= 0 || ply >= MAX_PLY - 1)
+            {
+                if (!position.hasMoves(player, rules.jumpDirections))
+                    return -SCORE_WIN + ply;
+                return evaluate(player);
+            }
+
+            int originalAlpha = alpha;
+            Move hashMove;
+            TTEntry entry;
+            if (probe(position.key(), entry))
+            {
+                hashMove = entry.move;
+                if (entry.depth >= depth)
+                {
+                    int score = scoreFromTT(entry.score, ply);
+                    if (entry.bound == BOUND_EXACT ||
+                        (entry.bound == BOUND_LOWER && score >= beta) ||
+                        (entry.bound == BOUND_UPPER && score <= alpha))
+                        return score;
+                }
+            }
+
+            MoveList<N> moves;
+            position.generateMoves(moves, rules.jumpDirections);
+            if (moves.empty())
+                return -SCORE_WIN + ply;
+
+            int *moveScores = scoreMoves(moves, player, ply, hashMove);
+            int best = -SCORE_INFINITE;
+            Move bestMove = moves[0];
+            for (int i = 0; i < moves.size(); i++)
+            {
+                pickNext(moves, i, moveScores);
+                Move move = moves[i];
+                Undo undo = position.make(move);
+                int score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+                position.unmake(move, undo);
+                if (stopped())
+                    return 0;
+
+                if (score > best)
+                {
+                    best = score;
+                    bestMove = move;
+                }
+                if (score > alpha)
+                    alpha = score;
+                if (alpha >= beta)
+                {
+                    if (!move.isCapture())
+                    {
+                        if (killers[ply][0] != move)
+                        {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = move;
+                        }
+                        int &entry = history[player - 1][move.from][move.to];
+                        entry += depth * depth;
+                        if (entry > HISTORY_MAX)
+                            ageHistory();
+                    }
+                    break;
+                }
+            }
+
+            Bound bound = best >= beta ? BOUND_LOWER : best > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+            store(position.key(), depth, scoreToTT(best, ply), bound, bestMove);
+            return best;
+        }
+
+        // Ordering scores: the hash move, captures, killers, then history
+        int *scoreMoves(const MoveList<N> &moves, int player, int ply, Move hashMove)
+        {
+            int *moveScores = scoreBuffer[ply];
+            for (int i = 0; i < moves.size(); i++)
+            {
+                const Move &move = moves[i];
+                if (move == hashMove)
+                    moveScores[i] = INT32_MAX;
+                else if (move.isCapture())
+                    moveScores[i] = 1 << 30;
+                else if (move == killers[ply][0])
+                    moveScores[i] = (1 << 29) + 1;
+                else if (move == killers[ply][1])
+                    moveScores[i] = 1 << 29;
+                else
+                    moveScores[i] = history[player - 1][move.from][move.to];
+            }
+            return moveScores;
+        }
+
+        // Selection step: bring the best remaining move to index i
+        static void pickNext(MoveList<N> &moves, int i, int *moveScores)
+        {
+            int bestIndex = i;
+            for (int j = i + 1; j < moves.size(); j++)
+            {
+                if (moveScores[j] > moveScores[bestIndex])
+                    bestIndex = j;
+            }
+            if (bestIndex != i)
+            {
+                Move move = moves[i];
+                moves[i] = moves[bestIndex];
+                moves[bestIndex] = move;
+                int score = moveScores[i];
+                moveScores[i] = moveScores[bestIndex];
+                moveScores[bestIndex] = score;
+            }
+        }
+    };
+
+    SearchLimits limits;
+    Rules rules;
+    std::chrono::steady_clock::time_point startTime;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> searchedNodes{0}; // all threads' nodes, for maxNodes
+
+    TranspositionTable tt; // shared by every thread
+    const Tablebase<N> *tablebase = nullptr;
+    Evaluator<N> evaluator;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    double elapsedSeconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+};
+
+} // namespace bead
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "bitboard.h"
+#include "mapped_file.h"
+#include "rules.h"
+
+namespace bead
+{
+
+// Endgame tablebase: the game-theoretic value of every position with at
+// most maxBeads beads on the board, with the number of plies to the end of
+// the game under best play (the winner hurries, the loser stalls). A side
+// with no beads, or with beads but no legal move, has lost.
+//
+// File layout, all little-endian:
+//   TBHeader
+//   TBClass[classCount]       one per (own beads, opponent beads) pair
+//   entries                   one byte per position, class by class
+// Positions are stored from the side to move's point of view, so a class
+// (us, them) covers both players. An entry is 0 for a draw, otherwise the
+// distance in plies plus one; an odd distance is a win for the side to
+// move and an even one a loss. Within a class a position's index is
+// rank(us) * C(CELLS - us, them) + rank(them among the cells us leaves
+// free), where rank is the colexicographic rank of a set of cells.
+
+const uint32_t TB_MAGIC = 0x31425442; // "BTB1"
+const uint16_t TB_VERSION = 1;
+const int TB_MAX_BEADS = 8;
+
+enum TBValue : uint8_t
+{
+    TB_DRAW,
+    TB_WIN,
+    TB_LOSS
+};
+
+struct TBResult
+{
+    TBValue value = TB_DRAW;
+    int distance = 0; // plies to the end of the game; 0 for a draw
+};
+
+struct TBHeader
+{
+    uint32_t magic = TB_MAGIC;
+    uint16_t version = TB_VERSION;
+    uint8_t size = 0; // grid size N
+    uint8_t maxBeads = 0;
+    uint32_t jumpDirections = 0;
+    uint32_t classCount = 0;
+};
+
+struct TBClass
+{
+    uint8_t us = 0;
+    uint8_t them = 0;
+    uint8_t reserved[6] = {};
+    uint64_t offset = 0; // of the first entry, from the start of the file
+    uint64_t count = 0;
+};
+
+static_assert(sizeof(TBHeader) == 16 && sizeof(TBClass) == 24, "tablebase records are stored as is");
+
+inline TBResult decodeTB(uint8_t entry)
+{
+    TBResult result;
+    if (entry == 0)
+        return result;
+    result.distance = entry - 1;
+    result.value = result.distance % 2 ? TB_WIN : TB_LOSS;
+    return result;
+}
+
+// Position indexing shared by the generator and the probe
+template <int N>
+struct TBIndex
+{
+    using Mask = typename BitBoard<N>::Mask;
+
+    static constexpr int CELLS = N * N;
+
+    struct Binomials
+    {
+        uint64_t c[CELLS + 1][TB_MAX_BEADS + 1] = {};
+    };
+
+    static constexpr Binomials build()
+    {
+        Binomials b{};
+        for (int n = 0; n <= CELLS; n++)
+        {
+            b.c[n][0] = 1;
+            for (int k = 1; k <= TB_MAX_BEADS; k++)
+                b.c[n][k] = n == 0 ? 0 : b.c[n - 1][k - 1] + b.c[n - 1][k];
+        }
+        return b;
+    }
+
+    static constexpr Binomials BINOMIALS = build();
+
+    static uint64_t choose(int n, int k)
+    {
+        return BINOMIALS.c[n][k];
+    }
+
+    static uint64_t classSize(int us, int them)
+    {
+        return choose(CELLS, us) * choose(CELLS - us, them);
+    }
+
+    // Colexicographic rank of a set of cells among sets of the same size
+    static uint64_t rank(Mask cells)
+    {
+        uint64_t r = 0;
+        for (int i = 1; cells; i++)
+        {
+            r += choose(lowestBit(cells), i);
+            cells &= cells - 1;
+        }
+        return r;
+    }
+
+    // Renumber the cells of set as if the cells in removed did not exist
+    static Mask compress(Mask set, Mask removed)
+    {
+        Mask result = 0;
+        while (set)
+        {
+            int sq = lowestBit(set);
+            Mask below = (Mask(1) << sq) - 1;
+            result |= Mask(1) << (sq - popCount(removed & below));
+            set &= set - 1;
+        }
+        return result;
+    }
+
+    static uint64_t index(Mask us, Mask them)
+    {
+        return rank(us) * choose(CELLS - popCount(us), popCount(them)) + rank(compress(them, us));
+    }
+};
+
+// Read-only, memory-mapped tablebase. probe() does no I/O beyond touching
+// one page of the map and is safe to call from any number of threads.
+template <int N>
+class Tablebase
+{
+public:
+    using Index = TBIndex<N>;
+    using Mask = typename BitBoard<N>::Mask;
+
+    bool open(const std::string &path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+        if (!validate())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        memset(classes, 0, sizeof(classes));
+        header = TBHeader();
+    }
+
+    bool isOpen() const
+    {
+        return file.isOpen();
+    }
+
+    int maxBeads() const
+    {
+        return header.maxBeads;
+    }
+
+    // The table holds this position and was built under these rules
+    bool covers(const BitBoard<N> &board, const Rules &rules) const
+    {
+        return isOpen() && popCount(board.occupied()) <= header.maxBeads &&
+               rules.jumpDirections == header.jumpDirections && !rules.captureChains;
+    }
+
+    // Value of the position for player, who is to move
+    bool probe(const BitBoard<N> &board, int player, TBResult &result) const
+    {
+        Mask us = board.own(player);
+        Mask them = board.opponent(player);
+        int ourCount = popCount(us);
+        int theirCount = popCount(them);
+        if (ourCount + theirCount > header.maxBeads)
+            return false;
+        if (ourCount == 0)
+        {
+            result.value = TB_LOSS;
+            result.distance = 0;
+            return true;
+        }
+        if (theirCount == 0)
+            return false; // the game ended before this position
+        const uint8_t *entries = classes[ourCount][theirCount];
+        if (!entries)
+            return false;
+        result = decodeTB(entries[Index::index(us, them)]);
+        return true;
+    }
+
+private:
+    MappedFile file;
+    TBHeader header;
+    const uint8_t *classes[TB_MAX_BEADS + 1][TB_MAX_BEADS + 1] = {};
+
+    // Reject files for another grid or version, and truncated files
+    bool validate()
+    {
+        if (file.size() < sizeof(TBHeader))
+            return false;
+        memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != TB_MAGIC || header.version != TB_VERSION || header.size != N ||
+            header.maxBeads > TB_MAX_BEADS)
+            return false;
+        if (file.size() < sizeof(TBHeader) + uint64_t(header.classCount) * sizeof(TBClass))
+            return false;
+
+        for (uint32_t i = 0; i < header.classCount; i++)
+        {
+            TBClass entry;
+            memcpy(&entry, file.data() + sizeof(TBHeader) + i * sizeof(TBClass), sizeof(entry));
+            if (entry.us > header.maxBeads || entry.them > header.maxBeads ||
+                entry.count != Index::classSize(entry.us, entry.them) || entry.offset > file.size() ||
+                entry.count > file.size() - entry.offset)
+                return false;
+            classes[entry.us][entry.them] = file.data() + entry.offset;
+        }
+        return true;
+    }
+};
+
+} // namespace bead
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bead
+{
+
+// Work-stealing thread pool. Every worker owns a task queue; it takes work
+// from the back of its own queue and, when that runs dry, steals from the
+// front of the others, so uneven tasks (long and short games) still keep
+// every core busy. Tasks receive the index of the worker running them,
+// which lets callers keep per-worker state such as a Searcher.
+class ThreadPool
+{
+public:
+    using Task = std::function<void(int worker)>;
+
+    // threads <= 0 uses every hardware thread
+    explicit ThreadPool(int threads = 0)
+    {
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < threads; i++)
+            queues.emplace_back(new Queue);
+        for (int i = 0; i < threads; i++)
+            workers.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const
+    {
+        return int(workers.size());
+    }
+
+    // Queue a task; submissions are spread round-robin over the workers
+    void submit(Task task)
+    {
+        pending++;
+        Queue &queue = *queues[nextQueue++ % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.lock);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepLock);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // Block until every submitted task has finished
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(sleepLock);
+        idle.wait(lock, [this] { return pending == 0; });
+    }
+
+private:
+    struct alignas(64) Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepLock;
+    std::condition_variable wake; // work queued or pool stopping
+    std::condition_variable idle; // pending reached zero
+    size_t queued = 0;            // tasks waiting in some queue, guarded by sleepLock
+    bool stopping = false;
+    std::atomic<size_t> pending{0}; // submitted and not yet finished
+    std::atomic<size_t> nextQueue{0};
+
+    // Own queue first (newest task), then steal the oldest task of another worker
+    bool pop(int worker, Task &task)
+    {
+        int count = int(queues.size());
+        for (int i = 0; i < count; i++)
+        {
+            Queue &queue = *queues[(worker + i) % count];
+            std::lock_guard<std::mutex> lock(queue.lock);
+            if (queue.tasks.empty())
+                continue;
+            if (i == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void run(int worker)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(sleepLock);
+                wake.wait(lock, [this] { return stopping || queued > 0; });
+                if (queued == 0)
+                    return; // stopping with nothing left to do
+                queued--;
+            }
+
+            // A queued task is reserved for this worker, so one of the queues holds it
+            Task task;
+            while (!pop(worker, task))
+                std::this_thread::yield();
+            task(worker);
+
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(sleepLock);
+                idle.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace bead
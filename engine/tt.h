@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "movegen.h"
+
+namespace bead
+{
+
+// Meaning of a stored score relative to the true value
+enum Bound : uint8_t
+{
+    BOUND_NONE,
+    BOUND_UPPER, // failed low: true score <= stored score
+    BOUND_LOWER, // failed high: true score >= stored score
+    BOUND_EXACT
+};
+
+struct TTEntry
+{
+    uint64_t key = 0;
+    int16_t score = 0;
+    uint8_t depth = 0;
+    uint8_t bound = BOUND_NONE;
+    uint8_t generation = 0;
+    Move move;
+
+    // Everything but the key in one word, so a slot is two plain stores
+    uint64_t pack() const
+    {
+        return uint64_t(uint16_t(score)) | uint64_t(depth) << 16 | uint64_t(bound) << 24 |
+               uint64_t(generation) << 32 | uint64_t(move.from) << 40 | uint64_t(move.to) << 48 |
+               uint64_t(move.flags) << 56;
+    }
+
+    static TTEntry unpack(uint64_t key, uint64_t data)
+    {
+        TTEntry entry;
+        entry.key = key;
+        entry.score = int16_t(uint16_t(data));
+        entry.depth = uint8_t(data >> 16);
+        entry.bound = uint8_t(data >> 24);
+        entry.generation = uint8_t(data >> 32);
+        entry.move = Move{uint8_t(data >> 40), uint8_t(data >> 48), uint8_t(data >> 56)};
+        return entry;
+    }
+};
+
+// Stored form of an entry. Threads read and write slots without locks;
+// check holds key ^ data, so a slot torn by two racing writers fails the
+// key comparison and reads as a miss instead of returning mixed data.
+struct TTSlot
+{
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+
+    uint64_t load(uint64_t &value) const
+    {
+        value = data.load(std::memory_order_relaxed);
+        return check.load(std::memory_order_relaxed) ^ value;
+    }
+
+    void save(uint64_t key, uint64_t value)
+    {
+        check.store(key ^ value, std::memory_order_relaxed);
+        data.store(value, std::memory_order_relaxed);
+    }
+};
+
+static_assert(sizeof(TTSlot) == 16, "four entries must share a cache line");
+
+// One cache line of entries that share a hash slot
+struct alignas(64) TTBucket
+{
+    TTSlot entries[4];
+};
+
+struct TTStats
+{
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    uint64_t stores = 0;
+    uint64_t tbHits = 0; // positions answered by the endgame tablebase
+
+    double hitRate() const
+    {
+        return probes ? double(hits) / probes : 0;
+    }
+};
+
+// Fixed-size transposition table. A probe touches one cache line; on a
+// full bucket the shallowest entry, or one left over from an older
+// search, is replaced. probe and store may be called from any number of
+// threads at once; resize, clear and newSearch may not run during a search.
+class TranspositionTable
+{
+public:
+    explicit TranspositionTable(size_t sizeMB = 16)
+    {
+        resize(sizeMB);
+    }
+
+    // Resize to the largest power-of-two bucket count that fits in sizeMB
+    void resize(size_t sizeMB)
+    {
+        size_t bytes = sizeMB * 1024 * 1024;
+        size_t count = 1;
+        while (count * 2 * sizeof(TTBucket) <= bytes)
+            count *= 2;
+        buckets.reset(new TTBucket[count]);
+        bucketCount = count;
+        mask = count - 1;
+        generation = 0;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < bucketCount; i++)
+            for (TTSlot &slot : buckets[i].entries)
+                slot.save(0, 0);
+        generation = 0;
+    }
+
+    size_t sizeBytes() const
+    {
+        return bucketCount * sizeof(TTBucket);
+    }
+
+    // Call once per search so older entries become preferred victims
+    void newSearch()
+    {
+        generation++;
+    }
+
+    bool probe(uint64_t key, TTEntry &found)
+    {
+        TTBucket &bucket = buckets[key & mask];
+        for (TTSlot &slot : bucket.entries)
+        {
+            uint64_t data;
+            if (slot.load(data) != key)
+                continue;
+            TTEntry entry = TTEntry::unpack(key, data);
+            if (entry.bound == BOUND_NONE)
+                continue;
+            if (entry.generation != generation)
+            {
+                entry.generation = generation;
+                slot.save(key, entry.pack());
+            }
+            found = entry;
+            return true;
+        }
+        return false;
+    }
+
+    void store(uint64_t key, int depth, int score, Bound bound, Move move)
+    {
+        TTBucket &bucket = buckets[key & mask];
+        TTSlot *victim = &bucket.entries[0];
+        int victimScore = INT32_MAX;
+        for (TTSlot &slot : bucket.entries)
+        {
+            uint64_t data;
+            uint64_t slotKey = slot.load(data);
+            TTEntry entry = TTEntry::unpack(slotKey, data);
+            if (slotKey == key || entry.bound == BOUND_NONE)
+            {
+                // Keep a deeper result for the same position unless this one is exact
+                if (slotKey == key && entry.bound != BOUND_NONE && depth < entry.depth && bound != BOUND_EXACT)
+                    return;
+                victim = &slot;
+                break;
+            }
+            int score = replaceScore(entry);
+            if (score < victimScore)
+            {
+                victim = &slot;
+                victimScore = score;
+            }
+        }
+
+        TTEntry entry;
+        entry.score = int16_t(score);
+        entry.depth = uint8_t(depth);
+        entry.bound = bound;
+        entry.generation = generation;
+        entry.move = move;
+        victim->save(key, entry.pack());
+    }
+
+private:
+    std::unique_ptr<TTBucket[]> buckets;
+    size_t bucketCount = 0;
+    size_t mask = 0;
+    uint8_t generation = 0;
+
+    // Lower is a better victim: shallow entries and entries from old searches
+    int replaceScore(const TTEntry &entry) const
+    {
+        int age = uint8_t(generation - entry.generation);
+        return entry.depth - 4 * age;
+    }
+};
+
+} // namespace bead
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include "bitboard.h"
+#include "geometry.h"
+#include "movegen.h"
+
+namespace bead
+{
+
+// Zobrist hashing for an N x N grid. The keys come from a fixed-seed
+// generator evaluated at compile time, so a position hashes the same in
+// every build and every process.
+template <int N>
+struct Zobrist
+{
+    static constexpr int CELLS = N * N;
+
+    struct Keys
+    {
+        uint64_t bead[2][CELLS] = {};
+        uint64_t side = 0; // toggled when player 2 is to move
+    };
+
+    static constexpr uint64_t splitMix(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr Keys build()
+    {
+        Keys keys{};
+        uint64_t state = 0x6265616431320000ull + N; // "bead12" plus the grid size
+        for (int player = 0; player < 2; player++)
+            for (int sq = 0; sq < CELLS; sq++)
+                keys.bead[player][sq] = splitMix(state);
+        keys.side = splitMix(state);
+        return keys;
+    }
+
+    static constexpr Keys KEYS = build();
+
+    // Full key of a position with player to move
+    static uint64_t key(const BitBoard<N> &board, int player)
+    {
+        uint64_t key = player == 2 ? KEYS.side : 0;
+        for (int p = 0; p < 2; p++)
+        {
+            typename BitBoard<N>::Mask beads = board.beads[p];
+            while (beads)
+            {
+                key ^= KEYS.bead[p][lowestBit(beads)];
+                beads &= beads - 1;
+            }
+        }
+        return key;
+    }
+
+    // Key change caused by player making move; applying it twice undoes it
+    static uint64_t moveDelta(int player, Move move)
+    {
+        uint64_t delta = KEYS.bead[player - 1][move.from] ^ KEYS.bead[player - 1][move.to];
+        if (!move.continues())
+            delta ^= KEYS.side;
+        if (move.isCapture())
+            delta ^= KEYS.bead[2 - player][Geometry<N>::middle(move.from, move.to)];
+        return delta;
+    }
+};
+
+} // namespace bead
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Decides when a game loop wakes up and when it redraws, so an idle window
+// sleeps instead of redrawing a static board as fast as it can.
+//
+// The loop calls wait() once per iteration. It returns when an event
+// arrives, when a wake-up time set with wakeAt() passes (the turn timer
+// ticking over), when another thread calls notify() (the computer
+// finished thinking) or when a requested redraw is due. beginFrame() then
+// says whether to draw. Input, requestRedraw() and animations make a frame
+// due; frames are never drawn faster than the frame rate cap.
+//
+// SFML 2 has no waitEvent with a timeout, so while idle the scheduler
+// polls for input every pollIntervalMs and sleeps in between.
+class FrameScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FrameScheduler(int maxFps = 60, int pollIntervalMs = 10)
+        : frameInterval(std::chrono::microseconds(1000000 / std::max(1, maxFps))),
+          pollInterval(std::chrono::milliseconds(pollIntervalMs))
+    {
+    }
+
+    // Redraw at the next opportunity
+    void requestRedraw()
+    {
+        dirty = true;
+    }
+
+    // Wake the loop no later than time; the earliest request wins
+    void wakeAt(Clock::time_point time)
+    {
+        wakeTime = std::min(wakeTime, time);
+    }
+
+    // Wake the loop from another thread
+    void notify()
+    {
+        notified = true;
+    }
+
+    // Redraw every frame, up to the frame rate cap, while animating
+    void setAnimating(bool animating)
+    {
+        this->animating = animating;
+    }
+
+    // Sleep until there is something to do
+    void wait(sf::RenderWindow &window)
+    {
+        while (window.isOpen())
+        {
+            if (!hasPending && window.pollEvent(pending))
+            {
+                hasPending = true;
+                dirty = true;
+                return;
+            }
+
+            Clock::time_point now = Clock::now();
+            if (notified.exchange(false))
+                return;
+            if (now >= wakeTime)
+            {
+                wakeTime = Clock::time_point::max();
+                return;
+            }
+            if ((dirty || animating) && now >= nextFrame)
+                return;
+
+            Clock::time_point until = now + pollInterval;
+            if (dirty || animating)
+                until = std::min(until, nextFrame);
+            until = std::min(until, wakeTime);
+            std::this_thread::sleep_until(until);
+        }
+    }
+
+    // Like RenderWindow::pollEvent, starting with any event wait() picked up
+    bool pollEvent(sf::RenderWindow &window, sf::Event &event)
+    {
+        if (hasPending)
+        {
+            event = pending;
+            hasPending = false;
+            return true;
+        }
+        if (!window.pollEvent(event))
+            return false;
+        dirty = true;
+        return true;
+    }
+
+    // True when this iteration should draw; call window.display() after drawing
+    bool beginFrame()
+    {
+        Clock::time_point now = Clock::now();
+        if (!(dirty || animating) || now < nextFrame)
+            return false;
+        dirty = false;
+        nextFrame = now + frameInterval;
+        return true;
+    }
+
+private:
+    Clock::duration frameInterval;
+    Clock::duration pollInterval;
+    Clock::time_point nextFrame;
+    Clock::time_point wakeTime = Clock::time_point::max();
+    std::atomic<bool> notified{false};
+    bool dirty = true; // the first frame is always drawn
+    bool animating = false;
+
+    sf::Event pending;
+    bool hasPending = false;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <initializer_list>
+#include <string>
+
+// An sf::Text that only re-lays out its glyphs when the string changes.
+// setString reports whether anything changed, so the caller knows when a
+// redraw is needed.
+class CachedText : public sf::Drawable
+{
+public:
+    CachedText(const sf::Font &font, unsigned size, float x, float y)
+        : text("", font, size)
+    {
+        text.setPosition(x, y);
+        text.setFillColor(sf::Color::Black);
+    }
+
+    bool setString(const std::string &value)
+    {
+        if (value == current)
+            return false;
+        current = value;
+        text.setString(value);
+        return true;
+    }
+
+    const std::string &getString() const
+    {
+        return current;
+    }
+
+protected:
+    void draw(sf::RenderTarget &target, sf::RenderStates states) const override
+    {
+        if (!current.empty())
+            target.draw(text, states);
+    }
+
+private:
+    sf::Text text;
+    std::string current;
+};
+
+// Text shown around the board: turn timer, whose turn it is, a status
+// line and the win message. Setters return true when the screen changed.
+class Hud
+{
+public:
+    Hud(const sf::Font &font, int boardSize)
+        : timer(font, 30, 350, float(boardSize + 20)), // next to the Load button
+          turn(font, 24, 50, float(boardSize + 150)),
+          status(font, 24, 250, float(boardSize + 150)),
+          win(font, 40, 50, float(boardSize / 2 - 20))
+    {
+    }
+
+    bool setTimer(int seconds)
+    {
+        if (seconds == shownSeconds)
+            return false;
+        shownSeconds = seconds;
+        return timer.setString("Time: " + std::to_string(seconds) + "s");
+    }
+
+    bool setTurn(int player)
+    {
+        return turn.setString(player == 1 ? "Turn: Red" : "Turn: Blue");
+    }
+
+    bool setStatus(const std::string &message)
+    {
+        return status.setString(message);
+    }
+
+    bool setWin(const std::string &message)
+    {
+        return win.setString(message);
+    }
+
+    CachedText &winText()
+    {
+        return win;
+    }
+
+    // Timer, turn and status below the board
+    void drawPanel(sf::RenderTarget &target) const
+    {
+        target.draw(timer);
+        target.draw(turn);
+        target.draw(status);
+    }
+
+    void drawWin(sf::RenderTarget &target) const
+    {
+        target.draw(win);
+    }
+
+private:
+    CachedText timer;
+    CachedText turn;
+    CachedText status;
+    CachedText win;
+    int shownSeconds = -1;
+};
+
+// Load the HUD font and render the printable ASCII glyphs at the sizes the
+// game uses, so the glyph atlas is complete before the first frame.
+inline bool loadFont(sf::Font &font, const std::string &path, std::initializer_list<unsigned> sizes)
+{
+    if (!font.loadFromFile(path))
+        return false;
+    for (unsigned size : sizes)
+        for (sf::Uint32 c = ' '; c <= '~'; c++)
+            font.getGlyph(c, size, false);
+    return true;
+}
@@ -0,0 +1,204 @@
+// Endgame analysis from the tablebase.
+//
+// Build: g++ -std=c++17 -O2 tools/analyze.cpp -o analyze
+// Usage: analyze [--tb FILE] [--side 1|2] [--size 4|5|6|8|10] [--diagonal]
+//                BOARD
+//
+// BOARD lists the rows from the top, separated by '/', with '.' for an
+// empty cell and '1' or '2' for a bead, e.g. "1...../....../..2.../
+// ....../....../.....1" on the default 6x6 grid. Prints the position's
+// value, the value of every legal move and a line of best play to the end
+// of the game. The tablebase is bead<size>.tb unless --tb names another.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../engine/engine.h"
+using namespace std;
+
+struct Options
+{
+    string tablebase; // bead<size>.tb when empty
+    string board;
+    int side = 1;
+    int size = 6;
+    bead::Rules rules;
+};
+
+string describe(const bead::TBResult &result)
+{
+    if (result.value == bead::TB_WIN)
+        return "win in " + to_string(result.distance);
+    if (result.value == bead::TB_LOSS)
+        return "loss in " + to_string(result.distance);
+    return "draw";
+}
+
+template <int N>
+string moveName(const bead::Move &move)
+{
+    string name = "(" + to_string(move.from / N) + "," + to_string(move.from % N) + ")";
+    name += move.isCapture() ? "x" : "-";
+    return name + "(" + to_string(move.to / N) + "," + to_string(move.to % N) + ")";
+}
+
+// Value of the position after move for the player who made it
+template <int N>
+bead::TBResult afterMove(const bead::Tablebase<N> &tablebase, bead::Position<N> position, const bead::Move &move)
+{
+    position.make(move);
+    bead::TBResult reply;
+    tablebase.probe(position.bitboard(), position.sideToMove(), reply);
+    bead::TBResult result;
+    if (reply.value == bead::TB_LOSS)
+        result.value = bead::TB_WIN;
+    else if (reply.value == bead::TB_WIN)
+        result.value = bead::TB_LOSS;
+    result.distance = reply.value == bead::TB_DRAW ? 0 : reply.distance + 1;
+    return result;
+}
+
+// Better for the mover: quicker wins, then draws, then slower losses
+bool better(const bead::TBResult &a, const bead::TBResult &b)
+{
+    auto rank = [](const bead::TBResult &r) {
+        if (r.value == bead::TB_WIN)
+            return 1000 - r.distance;
+        if (r.value == bead::TB_LOSS)
+            return -1000 + r.distance;
+        return 0;
+    };
+    return rank(a) > rank(b);
+}
+
+template <int N>
+int run(const Options &options)
+{
+    const string &boardText = options.board;
+    const bead::Rules &rules = options.rules;
+    string path = options.tablebase.empty() ? "bead" + to_string(N) + ".tb" : options.tablebase;
+
+    bead::Game<N> game(rules);
+    game.clear();
+    int row = 0, col = 0;
+    for (char c : boardText)
+    {
+        if (c == '/')
+        {
+            row++;
+            col = 0;
+            continue;
+        }
+        if (!bead::Game<N>::isValid(row, col) || (c != '.' && c != '1' && c != '2'))
+        {
+            cerr << "Invalid board: " << boardText << "\n";
+            return 1;
+        }
+        game.set(row, col++, c == '.' ? 0 : c - '0');
+    }
+    game.setSideToMove(options.side);
+
+    bead::Tablebase<N> tablebase;
+    if (!tablebase.open(path))
+    {
+        cerr << "Could not open tablebase " << path << "\n";
+        return 1;
+    }
+    if (!tablebase.covers(game.position().bitboard(), rules))
+    {
+        cerr << "The tablebase does not cover this position (at most " << tablebase.maxBeads()
+             << " beads, built for the other jump rule?)\n";
+        return 1;
+    }
+
+    bead::Position<N> position = game.position();
+    bead::TBResult value;
+    tablebase.probe(position.bitboard(), position.sideToMove(), value);
+    cout << "Player " << position.sideToMove() << " to move: " << describe(value) << "\n\nMoves:\n";
+
+    bead::MoveList<N> moves;
+    position.generateMoves(moves, rules.jumpDirections);
+    for (const bead::Move &move : moves)
+        cout << "  " << moveName<N>(move) << "  " << describe(afterMove(tablebase, position, move)) << "\n";
+
+    // Best play until the game ends, or a few moves into a draw
+    cout << "\nBest line:";
+    for (int ply = 0; ply < 40; ply++)
+    {
+        int player = position.sideToMove();
+        position.generateMoves(moves, rules.jumpDirections);
+        if (position.count(player) == 0 || moves.empty())
+        {
+            cout << " (player " << player << " cannot move and loses)";
+            break;
+        }
+        if (value.value == bead::TB_DRAW && ply >= 8)
+        {
+            cout << " ...";
+            break;
+        }
+        bead::Move best = moves[0];
+        bead::TBResult bestResult = afterMove(tablebase, position, best);
+        for (const bead::Move &move : moves)
+        {
+            bead::TBResult result = afterMove(tablebase, position, move);
+            if (better(result, bestResult))
+            {
+                best = move;
+                bestResult = result;
+            }
+        }
+        cout << " " << moveName<N>(best);
+        position.make(best);
+    }
+    cout << "\n";
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: analyze [--tb FILE] [--side 1|2] [--size 4|5|6|8|10] [--diagonal]\n"
+            "               BOARD\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--tb" && i + 1 < argc)
+            options.tablebase = argv[++i];
+        else if (arg == "--side" && i + 1 < argc)
+            options.side = atoi(argv[++i]);
+        else if (arg == "--size" && i + 1 < argc)
+            options.size = atoi(argv[++i]);
+        else if (arg == "--diagonal")
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+        else if (options.board.empty() && arg[0] != '-')
+            options.board = arg;
+        else
+            options.board.clear(), i = argc;
+    }
+    if (options.board.empty() || (options.side != 1 && options.side != 2))
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
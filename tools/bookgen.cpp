@@ -0,0 +1,305 @@
+// Opening book builder: plays computer self-play games from the starting
+// position and records how every early move scored.
+//
+// Build: g++ -std=c++17 -O2 -pthread tools/bookgen.cpp -o bookgen
+// Usage: bookgen [--games N] [--depth D] [--plies P] [--random-plies R]
+//                [--min-games M] [--max-plies PLIES] [--threads T]
+//                [--hash MB] [--seed S] [--size 4|5|6|8|10] [--diagonal]
+//                [--out FILE]
+//
+// Each game starts with R random plies, so the book sees more than one
+// line, then both sides search to depth D. The first P plies of every game
+// are recorded; moves played in fewer than M games are left out. The
+// output (default bead<size>.book) is read by bead::OpeningBook.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../engine/engine.h"
+#include "../engine/thread_pool.h"
+using namespace std;
+
+struct Options
+{
+    long games = 2000;
+    int depth = 4;
+    int plies = 10;       // book depth
+    int randomPlies = 2;  // random moves at the start of each game
+    long minGames = 4;
+    int maxPlies = 200;   // longer games are drawn
+    int threads = 0;
+    size_t hashMB = 1;
+    uint64_t seed = 1;
+    int size = 6;
+    bead::Rules rules;
+    string out; // bead<size>.book when empty
+};
+
+// Per-game random numbers; cheap and reproducible from the game's seed
+struct Random
+{
+    uint64_t state;
+
+    unsigned next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return unsigned((z ^ (z >> 31)) >> 32);
+    }
+};
+
+// A move from a position; the key of the book's statistics
+struct BookMove
+{
+    uint64_t key;
+    uint8_t from, to;
+
+    bool operator==(const BookMove &other) const
+    {
+        return key == other.key && from == other.from && to == other.to;
+    }
+};
+
+struct BookMoveHash
+{
+    size_t operator()(const BookMove &move) const
+    {
+        return size_t(move.key ^ ((uint64_t(move.from) << 8 | move.to) * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+using Statistics = unordered_map<BookMove, bead::BookEntry, BookMoveHash>;
+
+// Searchers are large, so each worker keeps one for all its games, and
+// collects statistics on its own so no locking is needed
+template <int N>
+struct WorkerState
+{
+    unique_ptr<bead::Searcher<N>> searcher;
+    Statistics statistics;
+};
+
+struct Played
+{
+    BookMove move;
+    uint8_t flags;
+    int player;
+};
+
+// Play one game and add its book moves to statistics
+template <int N>
+void playGame(const Options &options, bead::Searcher<N> &searcher, uint64_t seed, Statistics &statistics)
+{
+    bead::Game<N> game(options.rules);
+    Random random{seed};
+    bead::MoveList<N> moves;
+    vector<Played> played;
+    int winner = 0;
+
+    for (int ply = 0; ply < options.maxPlies; ply++)
+    {
+        int player = game.sideToMove();
+        // No beads, or no way to move them, loses the game
+        game.generateMoves(moves);
+        if (game.position().count(player) == 0 || moves.empty())
+        {
+            winner = 3 - player;
+            break;
+        }
+
+        bead::Move move;
+        if (ply < options.randomPlies)
+            move = moves[random.next() % moves.size()];
+        else
+        {
+            bead::SearchLimits limits;
+            limits.maxDepth = options.depth;
+            move = searcher.search(game.position(), limits, game.rules()).best;
+        }
+        if (ply < options.plies)
+            played.push_back({{game.position().key(), move.from, move.to}, move.flags, player});
+        game.play(move);
+    }
+
+    for (const Played &p : played)
+    {
+        bead::BookEntry &entry = statistics[p.move];
+        entry.key = p.move.key;
+        entry.from = p.move.from;
+        entry.to = p.move.to;
+        entry.flags = p.flags;
+        entry.games++;
+        if (winner == p.player)
+            entry.wins++;
+        else if (winner == 0)
+            entry.draws++;
+    }
+}
+
+template <int N>
+int run(const Options &options)
+{
+    auto start = chrono::steady_clock::now();
+    vector<WorkerState<N>> workers;
+    {
+        bead::ThreadPool pool(options.threads);
+        workers.resize(pool.size());
+        cerr << "Playing " << options.games << " games at depth " << options.depth << " on " << pool.size()
+             << " threads" << endl;
+
+        for (long g = 0; g < options.games; g++)
+        {
+            pool.submit([&options, &workers, g](int worker) {
+                WorkerState<N> &state = workers[worker];
+                if (!state.searcher)
+                    state.searcher.reset(new bead::Searcher<N>(options.hashMB));
+                // A fresh table per game keeps the book independent of scheduling
+                state.searcher->clearHistory();
+                uint64_t seed = options.seed * 0x9E3779B97F4A7C15ull + uint64_t(g);
+                playGame(options, *state.searcher, seed, state.statistics);
+            });
+        }
+        pool.wait();
+    }
+
+    // Merge the workers' statistics and keep the moves seen often enough
+    Statistics merged = move(workers[0].statistics);
+    for (size_t w = 1; w < workers.size(); w++)
+    {
+        for (const auto &item : workers[w].statistics)
+        {
+            bead::BookEntry &entry = merged[item.first];
+            if (entry.games == 0)
+                entry = item.second;
+            else
+            {
+                entry.games += item.second.games;
+                entry.wins += item.second.wins;
+                entry.draws += item.second.draws;
+            }
+        }
+    }
+    vector<bead::BookEntry> entries;
+    for (const auto &item : merged)
+    {
+        if (item.second.games >= uint64_t(options.minGames))
+            entries.push_back(item.second);
+    }
+    sort(entries.begin(), entries.end(), [](const bead::BookEntry &a, const bead::BookEntry &b) {
+        if (a.key != b.key)
+            return a.key < b.key;
+        if (a.games != b.games)
+            return a.games > b.games;
+        return (a.from << 8 | a.to) < (b.from << 8 | b.to);
+    });
+
+    bead::BookHeader header;
+    header.size = N;
+    header.jumpDirections = options.rules.jumpDirections;
+    header.entryCount = entries.size();
+    string out = options.out.empty() ? "bead" + to_string(N) + ".book" : options.out;
+    ofstream file(out, ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(bead::BookEntry));
+    if (!file)
+    {
+        cerr << "Error writing " << out << endl;
+        return 1;
+    }
+
+    size_t positions = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (i == 0 || entries[i].key != entries[i - 1].key)
+            positions++;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Wrote " << out << ": " << entries.size() << " moves from " << positions << " positions, "
+         << merged.size() << " seen in total, " << seconds << " s" << endl;
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: bookgen [--games N] [--depth D] [--plies P] [--random-plies R]\n"
+            "               [--min-games M] [--max-plies PLIES] [--threads T]\n"
+            "               [--hash MB] [--seed S] [--size 4|5|6|8|10] [--diagonal]\n"
+            "               [--out FILE]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+        {
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--games")
+            options.games = atol(value.c_str());
+        else if (arg == "--depth")
+            options.depth = atoi(value.c_str());
+        else if (arg == "--plies")
+            options.plies = atoi(value.c_str());
+        else if (arg == "--random-plies")
+            options.randomPlies = atoi(value.c_str());
+        else if (arg == "--min-games")
+            options.minGames = atol(value.c_str());
+        else if (arg == "--max-plies")
+            options.maxPlies = atoi(value.c_str());
+        else if (arg == "--threads")
+            options.threads = atoi(value.c_str());
+        else if (arg == "--hash")
+            options.hashMB = atol(value.c_str());
+        else if (arg == "--seed")
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--size")
+            options.size = atoi(value.c_str());
+        else if (arg == "--out")
+            options.out = value;
+        else
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (options.depth < 1 || options.depth >= bead::MAX_PLY)
+    {
+        cerr << "--depth must be between 1 and " << bead::MAX_PLY - 1 << "\n";
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
@@ -0,0 +1,245 @@
+// Speed and correctness of capture chain generation (Rules::captureChains).
+//
+// Build: g++ -std=c++17 -O2 tools/chainbench.cpp -o chainbench
+// Usage: chainbench [--positions P] [--rounds R] [--size 4|5|6|8|10]
+//                   [--density PERCENT] [--seed S] [--diagonal]
+//
+// Builds P boards with PERCENT of the cells (default 60) holding beads of
+// either player at random, since chains are rare in positions from real
+// games. generateChains, which walks the chains with make/unmake and drops
+// equivalent ones as it goes, runs R times over them. A plain walk that
+// copies the board at every jump and follows every order of the same jumps
+// runs once. Both report ns/position and chains/s, and any position where
+// the two find different chains is printed and fails the run.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../engine/engine.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Options
+{
+    size_t positions = 20000;
+    int rounds = 10;
+    int size = 6;
+    int density = 60;
+    uint64_t seed = 1;
+    bead::Rules rules;
+};
+
+// Start, end and captured beads (low and high 64 bits) of one chain
+using ChainKey = tuple<int, int, uint64_t, uint64_t>;
+
+template <int N>
+ChainKey chainKey(int from, int to, typename bead::BitBoard<N>::Mask captured)
+{
+    uint64_t high = 0;
+    if constexpr (sizeof(captured) > sizeof(uint64_t))
+        high = uint64_t(captured >> 64);
+    return ChainKey(from, to, uint64_t(captured), high);
+}
+
+// Random boards, each with its side to move
+template <int N>
+vector<bead::Position<N>> buildPositions(const Options &options)
+{
+    vector<bead::Position<N>> positions;
+    uint64_t state = options.seed;
+    auto next = [&state] {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return unsigned(state >> 33);
+    };
+    while (positions.size() < options.positions)
+    {
+        bead::Position<N> position;
+        for (int row = 0; row < N; row++)
+        {
+            for (int col = 0; col < N; col++)
+            {
+                if (int(next() % 100) < options.density)
+                    position.set(row, col, 1 + next() % 2);
+            }
+        }
+        position.setSideToMove(1 + next() % 2);
+        if (position.count(1) > 0 && position.count(2) > 0)
+            positions.push_back(position);
+    }
+    return positions;
+}
+
+// Every order of every chain, on a fresh copy of the board for each jump
+template <int N>
+void copyingWalk(const bead::BitBoard<N> &board, int player, unsigned jumpDirections, int from, int at,
+                 typename bead::BitBoard<N>::Mask captured, set<ChainKey> &found)
+{
+    using Geo = bead::Geometry<N>;
+    for (int to = 0; to < N * N; to++)
+    {
+        if (!Geo::isJump(at, to, jumpDirections) || board.at(to / N, to % N) != 0 ||
+            board.at(Geo::middle(at, to) / N, Geo::middle(at, to) % N) != 3 - player)
+            continue;
+        bead::BitBoard<N> next = board;
+        bead::applyMove(next, player, bead::Move{uint8_t(at), uint8_t(to), bead::MOVE_CAPTURE});
+        auto taken = captured | bead::BitBoard<N>::bit(Geo::middle(at, to));
+        found.insert(chainKey<N>(from, to, taken));
+        copyingWalk(next, player, jumpDirections, from, to, taken, found);
+    }
+}
+
+template <int N>
+set<ChainKey> copyingChains(const bead::Position<N> &position, unsigned jumpDirections)
+{
+    set<ChainKey> found;
+    const bead::BitBoard<N> &board = position.bitboard();
+    int player = position.sideToMove();
+    for (int from = 0; from < N * N; from++)
+    {
+        if (board.at(from / N, from % N) == player)
+            copyingWalk(board, player, jumpDirections, from, from, typename bead::BitBoard<N>::Mask(0), found);
+    }
+    return found;
+}
+
+template <int N>
+int run(const Options &options)
+{
+    vector<bead::Position<N>> positions = buildPositions<N>(options);
+    unsigned directions = options.rules.jumpDirections;
+    bead::ChainList<N> chains;
+
+    uint64_t chainCount = 0, jumpCount = 0, overflows = 0;
+    int longest = 0;
+    auto start = Clock::now();
+    for (int round = 0; round < options.rounds; round++)
+    {
+        for (const bead::Position<N> &position : positions)
+        {
+            bead::generateChains(position.bitboard(), position.sideToMove(), chains, directions);
+            chainCount += chains.size();
+            overflows += chains.overflowed();
+            for (int i = 0; i < chains.size(); i++)
+            {
+                jumpCount += chains[i].length;
+                longest = max(longest, int(chains[i].length));
+            }
+        }
+    }
+    double fastSeconds = chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t copyingCount = 0;
+    vector<set<ChainKey>> expected;
+    expected.reserve(positions.size());
+    start = Clock::now();
+    for (const bead::Position<N> &position : positions)
+    {
+        expected.push_back(copyingChains(position, directions));
+        copyingCount += expected.back().size();
+    }
+    double copyingSeconds = chrono::duration<double>(Clock::now() - start).count();
+
+    int mismatches = 0;
+    for (size_t p = 0; p < positions.size(); p++)
+    {
+        bead::generateChains(positions[p].bitboard(), positions[p].sideToMove(), chains, directions);
+        if (chains.overflowed())
+            continue;
+        set<ChainKey> found;
+        for (int i = 0; i < chains.size(); i++)
+            found.insert(chainKey<N>(chains[i].from, chains[i].to, chains[i].captured));
+        if (found.size() != size_t(chains.size()) || found != expected[p])
+        {
+            if (mismatches++ < 10)
+                cerr << "Position " << p << ": " << chains.size() << " chains, copying walk found "
+                     << expected[p].size() << "\n";
+        }
+    }
+
+    double generated = double(positions.size()) * options.rounds;
+    cout << fixed << setprecision(2);
+    cout << N << "x" << N << ", " << positions.size() << " positions at " << options.density << "% beads x "
+         << options.rounds << " rounds\n";
+    cout << "Chains: " << chainCount / generated << " per position, " << double(jumpCount) / max<uint64_t>(chainCount, 1)
+         << " jumps on average, longest " << longest << ", " << overflows << " lists overflowed\n";
+    cout << "generateChains: " << fastSeconds * 1e9 / generated << " ns/position, " << setprecision(0)
+         << (fastSeconds > 0 ? chainCount / fastSeconds : 0) << " chains/s\n";
+    cout << setprecision(2) << "Copying walk:   " << copyingSeconds * 1e9 / positions.size() << " ns/position, "
+         << setprecision(0) << (copyingSeconds > 0 ? copyingCount / copyingSeconds : 0) << " chains/s\n";
+    if (mismatches > 0)
+    {
+        cout << mismatches << " positions with different chains\n";
+        return 1;
+    }
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: chainbench [--positions P] [--rounds R] [--size 4|5|6|8|10]\n"
+            "                  [--density PERCENT] [--seed S] [--diagonal]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+        {
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--positions")
+            options.positions = strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--rounds")
+            options.rounds = atoi(value.c_str());
+        else if (arg == "--size")
+            options.size = atoi(value.c_str());
+        else if (arg == "--density")
+            options.density = atoi(value.c_str());
+        else if (arg == "--seed")
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        else
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (options.positions == 0 || options.rounds <= 0 || options.density <= 0 || options.density > 100)
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
@@ -0,0 +1,160 @@
+// Speed of the static evaluation: the batch evaluator against the scalar
+// reference it must agree with.
+//
+// Build: g++ -std=c++17 -O2 tools/evalbench.cpp -o evalbench
+//        (add -mavx2 or -march=native for the wider vector instructions)
+// Usage: evalbench [--positions P] [--rounds R] [--size 4|5|6|8|10] [--seed S]
+//                  [--diagonal]
+//
+// Builds P positions by seeded random play, scores each of them R times
+// with Evaluator::evaluate one position at a time and with
+// Evaluator::evaluateBatch, and reports ns/position for both. Any position
+// the two score differently is printed and fails the run.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Options
+{
+    size_t positions = 100000;
+    int rounds = 20;
+    int size = 6;
+    uint64_t seed = 1;
+    bead::Rules rules;
+};
+
+// Positions from random games, a few from every stage of the game
+template <int N>
+vector<bead::Position<N>> buildPositions(const Options &options)
+{
+    vector<bead::Position<N>> positions;
+    uint64_t state = options.seed;
+    while (positions.size() < options.positions)
+    {
+        bead::Game<N> game(options.rules);
+        bead::MoveList<N> moves;
+        for (int ply = 0; ply < 200 && positions.size() < options.positions; ply++)
+        {
+            game.generateMoves(moves);
+            if (moves.empty() || game.winner() != 0)
+                break;
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            game.play(moves[(state >> 33) % moves.size()]);
+            positions.push_back(game.position());
+        }
+    }
+    return positions;
+}
+
+template <int N>
+int run(const Options &options)
+{
+    vector<bead::Position<N>> positions = buildPositions<N>(options);
+    unsigned directions = options.rules.jumpDirections;
+    bead::Evaluator<N> evaluator;
+    vector<int> scalar(positions.size()), batch(positions.size());
+
+    auto start = Clock::now();
+    for (int round = 0; round < options.rounds; round++)
+    {
+        for (size_t i = 0; i < positions.size(); i++)
+            scalar[i] = evaluator.evaluate(positions[i], directions);
+    }
+    double scalarSeconds = chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int round = 0; round < options.rounds; round++)
+        evaluator.evaluateBatch(positions.data(), positions.size(), batch.data(), directions);
+    double batchSeconds = chrono::duration<double>(Clock::now() - start).count();
+
+    int mismatches = 0;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (scalar[i] != batch[i] && mismatches++ < 10)
+            cerr << "Position " << i << ": scalar " << scalar[i] << ", batch " << batch[i] << "\n";
+    }
+
+    double evaluations = double(positions.size()) * options.rounds;
+    cout << fixed << setprecision(2);
+    cout << N << "x" << N << ", " << positions.size() << " positions x " << options.rounds << " rounds, "
+         << bead::EVAL_LANES << " lanes\n";
+    cout << "Scalar: " << scalarSeconds * 1e9 / evaluations << " ns/position\n";
+    cout << "Batch:  " << batchSeconds * 1e9 / evaluations << " ns/position ("
+         << (batchSeconds > 0 ? scalarSeconds / batchSeconds : 0) << "x)\n";
+    if (mismatches > 0)
+    {
+        cout << mismatches << " positions scored differently\n";
+        return 1;
+    }
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: evalbench [--positions P] [--rounds R] [--size 4|5|6|8|10] [--seed S]\n"
+            "                 [--diagonal]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+        {
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--positions")
+            options.positions = strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--rounds")
+            options.rounds = atoi(value.c_str());
+        else if (arg == "--size")
+            options.size = atoi(value.c_str());
+        else if (arg == "--seed")
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        else
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (options.positions == 0 || options.rounds <= 0)
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
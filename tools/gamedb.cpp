@@ -0,0 +1,388 @@
+// Game database tool: builds archives of games and queries them by position.
+//
+// Build: g++ -std=c++17 -O2 -pthread tools/gamedb.cpp -o gamedb
+// Usage: gamedb selfplay DB [--games N] [--depth D] [--random-plies R]
+//                           [--max-plies P] [--index-plies P] [--threads T]
+//                           [--seed S] [--diagonal]
+//        gamedb import DB [--index-plies P] [--diagonal] SAVE...
+//        gamedb info DB
+//        gamedb stats DB [--side 1|2] POSITION
+//        gamedb find DB [--side 1|2] [--limit K] POSITION
+//        gamedb show DB ID
+//
+// Every command takes --size 4|5|6|8|10 for the grid size (default 6); a
+// database holds games of one size only.
+//
+// selfplay archives computer games: R random plies, then search to depth
+// D on both sides (0 plays the capture-first random policy). import
+// archives saved games (see engine/save_format.h); a game that did not
+// end counts as a draw. POSITION is "start" or the rows from the top,
+// separated by '/', with '.' for an empty cell and '1' or '2' for a bead.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+#include "../engine/thread_pool.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Options
+{
+    long games = 10000;
+    int depth = 0;
+    int randomPlies = 4;
+    int maxPlies = 200;
+    uint32_t indexPlies = UINT32_MAX;
+    int threads = 0;
+    uint64_t seed = 1;
+    int side = 1;
+    size_t limit = 20;
+    int size = 6;
+    bead::Rules rules;
+    vector<string> args; // everything that is not an option
+};
+
+// Per-game random numbers; cheap and reproducible from the game's seed
+struct Random
+{
+    uint64_t state;
+
+    unsigned next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return unsigned((z ^ (z >> 31)) >> 32);
+    }
+};
+
+double millisecondsSince(Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// The winner of a finished game, or 0 if it has not ended
+template <int N>
+int finalResult(const bead::Game<N> &game)
+{
+    int player = game.sideToMove();
+    if (game.position().count(player) == 0 || !game.hasValidMoves(player))
+        return 3 - player;
+    return 0;
+}
+
+// Play one game; returns its result
+template <int N>
+int playGame(const Options &options, bead::Searcher<N> *searcher, uint64_t seed, bead::Game<N> &game)
+{
+    game = bead::Game<N>(options.rules);
+    Random random{seed};
+    bead::MoveList<N> moves;
+    for (int ply = 0; ply < options.maxPlies; ply++)
+    {
+        game.generateMoves(moves);
+        if (game.position().count(game.sideToMove()) == 0 || moves.empty())
+            return 3 - game.sideToMove();
+        if (ply < options.randomPlies)
+            game.play(moves[random.next() % moves.size()]);
+        else if (!searcher)
+            game.play(bead::randomMove(moves, random.next()));
+        else
+        {
+            bead::SearchLimits limits;
+            limits.maxDepth = options.depth;
+            game.play(searcher->search(game.position(), limits, game.rules()).best);
+        }
+    }
+    return 0;
+}
+
+template <int N>
+int selfplay(const Options &options, const string &path)
+{
+    auto start = Clock::now();
+    bead::GameDBWriter<N> writer(options.rules, options.indexPlies);
+    bead::ThreadPool pool(options.threads);
+    vector<unique_ptr<bead::Searcher<N>>> searchers(pool.size());
+    cerr << "Playing " << options.games << " games on " << pool.size() << " threads" << endl;
+
+    // Play in batches, adding each batch in order so the file does not
+    // depend on scheduling
+    const long BATCH = 4096;
+    vector<bead::Game<N>> games(BATCH);
+    vector<int> results(BATCH);
+    for (long first = 0; first < options.games; first += BATCH)
+    {
+        long count = min(BATCH, options.games - first);
+        for (long g = 0; g < count; g++)
+        {
+            pool.submit([&, g](int worker) {
+                bead::Searcher<N> *searcher = nullptr;
+                if (options.depth > 0)
+                {
+                    if (!searchers[worker])
+                        searchers[worker].reset(new bead::Searcher<N>(1));
+                    searchers[worker]->clearHistory();
+                    searcher = searchers[worker].get();
+                }
+                uint64_t seed = options.seed * 0x9E3779B97F4A7C15ull + uint64_t(first + g);
+                results[g] = playGame(options, searcher, seed, games[g]);
+            });
+        }
+        pool.wait();
+        for (long g = 0; g < count; g++)
+            writer.add(games[g], results[g]);
+    }
+    double played = millisecondsSince(start);
+
+    if (!writer.write(path))
+    {
+        cerr << "Error writing " << path << endl;
+        return 1;
+    }
+    cout << "Wrote " << path << ": " << writer.size() << " games, played in " << played / 1000 << " s, written in "
+         << (millisecondsSince(start) - played) / 1000 << " s" << endl;
+    return 0;
+}
+
+template <int N>
+int importSaves(const Options &options, const string &path)
+{
+    bead::GameDBWriter<N> writer(options.rules, options.indexPlies);
+    for (size_t i = 2; i < options.args.size(); i++)
+    {
+        bead::Game<N> game(options.rules);
+        int timeRemainingMs = 0;
+        bead::SaveStatus status = bead::readSaveFile(options.args[i], game, timeRemainingMs);
+        if (status != bead::SAVE_OK)
+        {
+            cerr << "Skipping " << options.args[i] << ": " << bead::saveStatusText(status) << "\n";
+            continue;
+        }
+        writer.add(game, finalResult(game));
+    }
+    if (!writer.write(path))
+    {
+        cerr << "Error writing " << path << endl;
+        return 1;
+    }
+    cout << "Wrote " << path << ": " << writer.size() << " games" << endl;
+    return 0;
+}
+
+template <int N>
+bool parsePosition(const string &text, int side, bead::Game<N> &game)
+{
+    if (side != 1 && side != 2)
+        return false;
+    if (text == "start")
+    {
+        game.reset();
+        game.setSideToMove(side);
+        return true;
+    }
+    game.clear();
+    int row = 0, col = 0;
+    for (char c : text)
+    {
+        if (c == '/')
+        {
+            row++;
+            col = 0;
+            continue;
+        }
+        if (!bead::Game<N>::isValid(row, col) || (c != '.' && c != '1' && c != '2'))
+            return false;
+        game.set(row, col++, c == '.' ? 0 : c - '0');
+    }
+    game.setSideToMove(side);
+    return true;
+}
+
+template <int N>
+string moveName(const bead::Move &move)
+{
+    if (move.isPass())
+        return "pass";
+    string name = "(" + to_string(move.from / N) + "," + to_string(move.from % N) + ")";
+    name += move.isCapture() ? "x" : "-";
+    return name + "(" + to_string(move.to / N) + "," + to_string(move.to % N) + ")";
+}
+
+string resultName(int result)
+{
+    return result == 0 ? "draw" : "player " + to_string(result) + " won";
+}
+
+template <int N>
+int query(const Options &options, const string &command, const bead::GameDB<N> &db)
+{
+    if (command == "info")
+    {
+        cout << db.size() << " games, " << db.positions() << " positions, " << db.moveBytes()
+             << " bytes of moves\n";
+        return 0;
+    }
+    if (command == "show")
+    {
+        if (options.args.size() != 3)
+            return -1;
+        uint32_t id = uint32_t(strtoul(options.args[2].c_str(), nullptr, 10));
+        bead::Game<N> game(db.rules());
+        if (!db.game(id, game))
+        {
+            cerr << "No game " << id << "\n";
+            return 1;
+        }
+        cout << "Game " << id << ": " << game.history().size() << " plies, " << resultName(db.result(id)) << "\n";
+        for (size_t i = 0; i < game.history().size(); i++)
+            cout << (i % 10 ? " " : i ? "\n" : "") << moveName<N>(game.history()[i]);
+        cout << "\n";
+        return 0;
+    }
+
+    bead::Game<N> position(db.rules());
+    if ((command != "stats" && command != "find") || options.args.size() != 3 ||
+        !parsePosition(options.args[2], options.side, position))
+        return -1;
+    auto start = Clock::now();
+    typename bead::GameDB<N>::PositionStats stats;
+    db.stats(position.position(), stats);
+    vector<uint32_t> ids;
+    if (command == "find")
+        db.gamesReaching(position.position(), ids, options.limit);
+    double elapsed = millisecondsSince(start);
+
+    cout << fixed << setprecision(1);
+    cout << stats.games << " games reach the position: player 1 won " << stats.wins[0] << ", player 2 won "
+         << stats.wins[1] << ", " << stats.draws() << " drawn\n";
+    if (stats.games > 0)
+        cout << "Score for player " << options.side << " to move: " << 100 * stats.score(options.side) << "%\n";
+    for (uint32_t id : ids)
+        cout << "  game " << id << ": " << db.plies(id) << " plies, " << resultName(db.result(id)) << "\n";
+    cout << setprecision(3) << "Query time: " << elapsed << " ms\n";
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: gamedb selfplay DB [--games N] [--depth D] [--random-plies R]\n"
+            "                          [--max-plies P] [--index-plies P] [--threads T]\n"
+            "                          [--seed S] [--diagonal]\n"
+            "       gamedb import DB [--index-plies P] [--diagonal] SAVE...\n"
+            "       gamedb info DB\n"
+            "       gamedb stats DB [--side 1|2] POSITION\n"
+            "       gamedb find DB [--side 1|2] [--limit K] POSITION\n"
+            "       gamedb show DB ID\n"
+            "       (each with [--size 4|5|6|8|10])\n";
+}
+
+template <int N>
+int run(const Options &options)
+{
+    const string &command = options.args[0];
+    const string &path = options.args[1];
+    if (command == "selfplay")
+    {
+        if (options.depth < 0 || options.depth >= bead::MAX_PLY)
+        {
+            cerr << "--depth must be between 0 and " << bead::MAX_PLY - 1 << "\n";
+            return 1;
+        }
+        return selfplay<N>(options, path);
+    }
+    if (command == "import")
+        return importSaves<N>(options, path);
+
+    auto start = Clock::now();
+    bead::GameDB<N> db;
+    if (!db.open(path))
+    {
+        cerr << "Could not open game database " << path << "\n";
+        return 1;
+    }
+    cerr << "Opened " << path << " in " << millisecondsSince(start) << " ms\n";
+    int status = query(options, command, db);
+    if (status < 0)
+    {
+        usage();
+        return 1;
+    }
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+        else if (arg.compare(0, 2, "--") != 0)
+            options.args.push_back(arg);
+        else if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        else
+        {
+            string value = argv[++i];
+            if (arg == "--games")
+                options.games = atol(value.c_str());
+            else if (arg == "--depth")
+                options.depth = atoi(value.c_str());
+            else if (arg == "--random-plies")
+                options.randomPlies = atoi(value.c_str());
+            else if (arg == "--max-plies")
+                options.maxPlies = atoi(value.c_str());
+            else if (arg == "--index-plies")
+                options.indexPlies = uint32_t(strtoul(value.c_str(), nullptr, 10));
+            else if (arg == "--threads")
+                options.threads = atoi(value.c_str());
+            else if (arg == "--seed")
+                options.seed = strtoull(value.c_str(), nullptr, 10);
+            else if (arg == "--side")
+                options.side = atoi(value.c_str());
+            else if (arg == "--limit")
+                options.limit = strtoul(value.c_str(), nullptr, 10);
+            else if (arg == "--size")
+                options.size = atoi(value.c_str());
+            else
+            {
+                cerr << "bad argument: " << arg << " " << value << "\n";
+                usage();
+                return 1;
+            }
+        }
+    }
+    if (options.args.size() < 2)
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
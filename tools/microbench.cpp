@@ -0,0 +1,503 @@
+// Micro-benchmarks of the rule checks, move generation and the computer's
+// move, for catching slowdowns in the hot path between builds.
+//
+// Build: g++ -std=c++17 -O2 tools/microbench.cpp -o microbench
+// Usage: microbench [--positions P] [--rounds R] [--size 4|5|6|8|10]
+//                   [--search-depth D] [--seed S] [--diagonal]
+//                   [--json] [--compare FILE] [--tolerance PERCENT]
+//
+// The corpus is P positions, half from uniformly random play and half from
+// games between depth-2 search players, all from seed S. Each benchmark
+// runs R times over the corpus and reports ns/op, heap allocations/op and
+// ops/s. hasValidMoves and checkWinCondition read the state a game keeps
+// up to date as it is played; moveCount and play time that refresh, which
+// recounts both players' moves after every move. --json prints the results
+// as JSON; --compare reads such a file from an earlier build and fails the
+// run if any benchmark got more than PERCENT (default 10) slower.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+// Every heap allocation in the process goes through here and is counted
+atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+struct Options
+{
+    size_t positions = 20000;
+    int rounds = 10;
+    int size = 6;
+    int searchDepth = 3;
+    uint64_t seed = 1;
+    bool json = false;
+    string compare;
+    double tolerance = 10;
+    bead::Rules rules;
+};
+
+struct Result
+{
+    string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0;
+    double allocationsPerOp = 0;
+
+    double opsPerSecond() const
+    {
+        return nsPerOp > 0 ? 1e9 / nsPerOp : 0;
+    }
+};
+
+// Results are folded in here so the compiler cannot drop the work
+volatile uint64_t sink;
+
+// Per-run random numbers; cheap and reproducible from the seed
+struct Random
+{
+    uint64_t state;
+
+    unsigned next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return unsigned((z ^ (z >> 31)) >> 32);
+    }
+};
+
+// A cell pair to ask the rule checks about
+struct Query
+{
+    uint32_t game;
+    int8_t srcRow, srcCol, desRow, desCol;
+};
+
+template <int N>
+struct Corpus
+{
+    vector<bead::Game<N>> games; // one per position, with an empty history
+    vector<Query> cells;         // both cells on the board
+    vector<Query> anywhere;      // cells up to two outside the board too
+    size_t randomPositions = 0;
+    size_t realPositions = 0;
+};
+
+template <int N>
+void addGames(const Options &options, Random &random, bead::Searcher<N> *searcher, size_t count,
+              Corpus<N> &corpus)
+{
+    size_t target = corpus.games.size() + count;
+    while (corpus.games.size() < target)
+    {
+        bead::Game<N> game(options.rules);
+        bead::MoveList<N> moves;
+        for (int ply = 0; ply < 200 && corpus.games.size() < target; ply++)
+        {
+            game.generateMoves(moves);
+            if (moves.empty() || game.winner() != 0)
+                break;
+            if (searcher && ply >= 4)
+            {
+                bead::SearchLimits limits;
+                limits.maxDepth = 2;
+                game.play(searcher->search(game.position(), limits, game.rules()).best);
+            }
+            else
+                game.play(moves[random.next() % moves.size()]);
+
+            bead::Game<N> entry(options.rules);
+            bead::GameDBWriter<N>::setPosition(entry, game.position());
+            corpus.games.push_back(entry);
+        }
+    }
+}
+
+template <int N>
+Corpus<N> buildCorpus(const Options &options)
+{
+    Corpus<N> corpus;
+    Random random{options.seed};
+    bead::Searcher<N> searcher(1);
+    addGames<N>(options, random, nullptr, options.positions / 2, corpus);
+    corpus.randomPositions = corpus.games.size();
+    addGames<N>(options, random, &searcher, options.positions - corpus.games.size(), corpus);
+    corpus.realPositions = corpus.games.size() - corpus.randomPositions;
+
+    // Mostly short hops from a bead of the side to move, as a player's clicks would be
+    for (uint32_t g = 0; g < corpus.games.size(); g++)
+    {
+        for (int q = 0; q < 16; q++)
+        {
+            int srcRow = random.next() % N, srcCol = random.next() % N;
+            int desRow = srcRow + int(random.next() % 5) - 2, desCol = srcCol + int(random.next() % 5) - 2;
+            corpus.anywhere.push_back(Query{g, int8_t(srcRow), int8_t(srcCol), int8_t(desRow), int8_t(desCol)});
+            if (bead::Game<N>::isValid(desRow, desCol))
+                corpus.cells.push_back(Query{g, int8_t(srcRow), int8_t(srcCol), int8_t(desRow), int8_t(desCol)});
+        }
+    }
+    return corpus;
+}
+
+// Time body, which does ops operations per call, over rounds calls
+template <typename Body>
+Result measure(const string &name, int rounds, uint64_t ops, Body body)
+{
+    body(); // warm up caches and tables
+    uint64_t allocationsBefore = allocations.load();
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++)
+        body();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    Result result;
+    result.name = name;
+    result.ops = ops * uint64_t(rounds);
+    result.nsPerOp = seconds * 1e9 / double(result.ops);
+    result.allocationsPerOp = double(allocations.load() - allocationsBefore) / double(result.ops);
+    return result;
+}
+
+template <int N>
+vector<Result> run(const Options &options, Corpus<N> &corpus)
+{
+    using BeadGame = bead::Game<N>;
+    const vector<BeadGame> &games = corpus.games;
+    const vector<Query> &cells = corpus.cells;
+    const vector<Query> &anywhere = corpus.anywhere;
+    vector<Result> results;
+
+    results.push_back(measure("isValid", options.rounds, anywhere.size(), [&] {
+        uint64_t count = 0;
+        for (const Query &q : anywhere)
+            count += BeadGame::isValid(q.desRow, q.desCol);
+        sink = count;
+    }));
+    results.push_back(measure("isEmpty", options.rounds, cells.size(), [&] {
+        uint64_t count = 0;
+        for (const Query &q : cells)
+            count += games[q.game].isEmpty(q.desRow, q.desCol);
+        sink = count;
+    }));
+    results.push_back(measure("isMovable", options.rounds, anywhere.size(), [&] {
+        uint64_t count = 0;
+        for (const Query &q : anywhere)
+        {
+            const BeadGame &game = games[q.game];
+            count += game.isMovable(game.sideToMove(), q.srcRow, q.srcCol, q.desRow, q.desCol);
+        }
+        sink = count;
+    }));
+    results.push_back(measure("isEdible", options.rounds, anywhere.size(), [&] {
+        uint64_t count = 0;
+        for (const Query &q : anywhere)
+        {
+            const BeadGame &game = games[q.game];
+            count += game.isEdible(game.sideToMove(), q.srcRow, q.srcCol, q.desRow, q.desCol);
+        }
+        sink = count;
+    }));
+    results.push_back(measure("calculateDistance", options.rounds, cells.size(), [&] {
+        uint64_t sum = 0;
+        for (const Query &q : cells)
+            sum += BeadGame::calculateDistance(q.srcRow, q.srcCol, q.desRow, q.desCol);
+        sink = sum;
+    }));
+    results.push_back(measure("hasValidMoves", options.rounds, games.size(), [&] {
+        uint64_t count = 0;
+        for (const BeadGame &game : games)
+            count += game.hasValidMoves(game.sideToMove());
+        sink = count;
+    }));
+    results.push_back(measure("moveCount", options.rounds, games.size(), [&] {
+        uint64_t count = 0;
+        for (const BeadGame &game : games)
+            count += game.position().moveCount(game.sideToMove(), game.rules().jumpDirections);
+        sink = count;
+    }));
+    results.push_back(measure("generateMoves", options.rounds, games.size(), [&] {
+        uint64_t count = 0;
+        bead::MoveList<N> moves;
+        for (const BeadGame &game : games)
+        {
+            game.generateMoves(moves);
+            count += moves.size();
+        }
+        sink = count;
+    }));
+    results.push_back(measure("checkWinCondition", options.rounds, games.size(), [&] {
+        uint64_t count = 0;
+        for (const BeadGame &game : games)
+            count += game.winner();
+        sink = count;
+    }));
+
+    // Moves play on a scratch game that keeps its history's storage, as
+    // the game in the front ends does. The search is single-threaded and
+    // starts every round with an empty table, so each round does the same
+    // work. Within a round the table carries over from one position to the
+    // next, as it does from move to move in a game.
+    size_t searchGames = min<size_t>(games.size(), 500);
+    bead::Searcher<N> searcher(1);
+    BeadGame scratch(options.rules);
+    vector<bead::Move> firstMoves;
+    {
+        bead::MoveList<N> moves;
+        for (const BeadGame &game : games)
+        {
+            game.generateMoves(moves);
+            firstMoves.push_back(moves.empty() ? bead::Move{0, 0, bead::MOVE_PASS} : moves[0]);
+        }
+    }
+    results.push_back(measure("play", options.rounds, games.size(), [&] {
+        uint64_t count = 0;
+        for (size_t g = 0; g < games.size(); g++)
+        {
+            scratch = games[g];
+            if (firstMoves[g].isPass())
+                continue;
+            scratch.play(firstMoves[g]);
+            count += scratch.hasValidMoves(scratch.sideToMove());
+        }
+        sink = count;
+    }));
+    results.push_back(measure("computerMove:random", options.rounds, games.size(), [&] {
+        uint64_t sum = 0;
+        bead::MoveList<N> moves;
+        Random random{options.seed};
+        for (const BeadGame &game : games)
+        {
+            scratch = game;
+            scratch.generateMoves(moves);
+            if (moves.empty())
+                continue;
+            scratch.play(bead::randomMove(moves, random.next()));
+            sum += scratch.position().key();
+        }
+        sink = sum;
+    }));
+    bead::SearchLimits limits;
+    limits.maxDepth = options.searchDepth;
+    results.push_back(measure("computerMove:depth" + to_string(options.searchDepth), options.rounds, searchGames,
+                              [&] {
+                                  uint64_t sum = 0;
+                                  searcher.clearHistory();
+                                  for (size_t g = 0; g < searchGames; g++)
+                                  {
+                                      scratch = games[g];
+                                      sum += scratch.computerMove(searcher, limits);
+                                  }
+                                  sink = sum;
+                              }));
+    return results;
+}
+
+void printText(const Options &options, size_t randomPositions, size_t realPositions, const vector<Result> &results)
+{
+    cout << options.size << "x" << options.size << ", " << randomPositions << " random and " << realPositions
+         << " real positions, " << options.rounds << " rounds\n";
+    cout << left << setw(22) << "benchmark" << right << setw(12) << "ns/op" << setw(12) << "allocs/op" << setw(16)
+         << "ops/s" << "\n";
+    for (const Result &r : results)
+    {
+        cout << left << setw(22) << r.name << right << fixed << setprecision(2) << setw(12) << r.nsPerOp << setw(12)
+             << r.allocationsPerOp << setprecision(0) << setw(16) << r.opsPerSecond() << "\n";
+    }
+}
+
+void printJson(const Options &options, size_t randomPositions, size_t realPositions, const vector<Result> &results)
+{
+    cout << "{\n  \"size\": " << options.size << ",\n  \"randomPositions\": " << randomPositions
+         << ",\n  \"realPositions\": " << realPositions << ",\n  \"rounds\": " << options.rounds
+         << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        cout << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << fixed << setprecision(3)
+             << ", \"nsPerOp\": " << r.nsPerOp << ", \"allocationsPerOp\": " << r.allocationsPerOp
+             << setprecision(0) << ", \"opsPerSecond\": " << r.opsPerSecond() << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    cout << "  ]\n}\n";
+}
+
+// Read back nsPerOp by name from a file printJson wrote
+bool readBaseline(const string &path, vector<Result> &baseline)
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+    string line;
+    while (getline(file, line))
+    {
+        size_t name = line.find("\"name\": \"");
+        size_t ns = line.find("\"nsPerOp\": ");
+        if (name == string::npos || ns == string::npos)
+            continue;
+        name += 9;
+        Result r;
+        r.name = line.substr(name, line.find('"', name) - name);
+        r.nsPerOp = atof(line.c_str() + ns + 11);
+        baseline.push_back(r);
+    }
+    return true;
+}
+
+// Benchmarks more than tolerance percent slower than the baseline
+int compare(const Options &options, const vector<Result> &results)
+{
+    vector<Result> baseline;
+    if (!readBaseline(options.compare, baseline))
+    {
+        cerr << "Could not read " << options.compare << "\n";
+        return 1;
+    }
+    int regressions = 0;
+    for (const Result &r : results)
+    {
+        for (const Result &old : baseline)
+        {
+            if (old.name != r.name || old.nsPerOp <= 0)
+                continue;
+            double change = 100 * (r.nsPerOp / old.nsPerOp - 1);
+            if (change > options.tolerance)
+            {
+                cerr << "Regression: " << r.name << " " << fixed << setprecision(2) << old.nsPerOp << " -> "
+                     << r.nsPerOp << " ns/op (+" << setprecision(1) << change << "%)\n";
+                regressions++;
+            }
+        }
+    }
+    return regressions > 0 ? 1 : 0;
+}
+
+template <int N>
+int benchmark(const Options &options)
+{
+    Corpus<N> corpus = buildCorpus<N>(options);
+    vector<Result> results = run<N>(options, corpus);
+    if (options.json)
+        printJson(options, corpus.randomPositions, corpus.realPositions, results);
+    else
+        printText(options, corpus.randomPositions, corpus.realPositions, results);
+    return options.compare.empty() ? 0 : compare(options, results);
+}
+
+void usage()
+{
+    cerr << "usage: microbench [--positions P] [--rounds R] [--size 4|5|6|8|10]\n"
+            "                  [--search-depth D] [--seed S] [--diagonal]\n"
+            "                  [--json] [--compare FILE] [--tolerance PERCENT]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+        {
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            continue;
+        }
+        if (arg == "--json")
+        {
+            options.json = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--positions")
+            options.positions = strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--rounds")
+            options.rounds = atoi(value.c_str());
+        else if (arg == "--size")
+            options.size = atoi(value.c_str());
+        else if (arg == "--search-depth")
+            options.searchDepth = atoi(value.c_str());
+        else if (arg == "--seed")
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--compare")
+            options.compare = value;
+        else if (arg == "--tolerance")
+            options.tolerance = atof(value.c_str());
+        else
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (options.positions < 2 || options.rounds <= 0 || options.searchDepth <= 0 ||
+        options.searchDepth >= bead::MAX_PLY)
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return benchmark<4>(options);
+    case 5:
+        return benchmark<5>(options);
+    case 6:
+        return benchmark<6>(options);
+    case 8:
+        return benchmark<8>(options);
+    case 10:
+        return benchmark<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
@@ -0,0 +1,531 @@
+// Move generation counts (perft): the number of move sequences of a given
+// length from a position, as ground truth for work on the move generator.
+//
+// Build: g++ -std=c++17 -O2 -pthread tools/perft.cpp -o perft
+// Usage: perft [--depth D] [--size 4|5|6|8|10] [--board BOARD] [--side 1|2]
+//              [--mode fast|reference|check] [--threads T] [--divide]
+//              [--diagonal]
+//
+// BOARD lists the rows from the top, separated by '/', with '.' for an
+// empty cell and '1' or '2' for a bead; "start" (the default) is the
+// starting setup. The fast mode counts with generateMoves and make/unmake,
+// taking the size of the move list at the last ply instead of playing it.
+// The reference mode runs the rule checks of the original front ends,
+// ported as they were onto a plain int grid: every pair of cells through
+// isEdible and isMovable, with pow/sqrt distances, and makeMove to play
+// them. It shares no code with the engine, so a mistake in the geometry
+// tables or in make shows up as a difference. The check mode runs both;
+// when they disagree it follows the first differing move down to the
+// position where the two move lists or boards differ and prints the moves
+// that lead there, the position and the moves only one of them found.
+// A game with a winner ends there in both modes. --threads splits the moves
+// at the root between threads; --divide prints the count below each of them.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+#include "../engine/thread_pool.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct Options
+{
+    int depth = 5;
+    int size = 6;
+    string board = "start";
+    int side = 1;
+    string mode = "fast";
+    int threads = 1;
+    bool divide = false;
+    bead::Rules rules;
+};
+
+template <int N>
+string moveName(const bead::Move &move)
+{
+    string name = "(" + to_string(move.from / N) + "," + to_string(move.from % N) + ")";
+    name += move.isCapture() ? "x" : "-";
+    return name + "(" + to_string(move.to / N) + "," + to_string(move.to % N) + ")";
+}
+
+// Board is bead::Game or ReferenceBoard
+template <int N, template <int> class Board>
+string boardText(const Board<N> &board)
+{
+    string text;
+    for (int row = 0; row < N; row++)
+    {
+        if (row > 0)
+            text += '/';
+        for (int col = 0; col < N; col++)
+            text += board.at(row, col) == 0 ? '.' : char('0' + board.at(row, col));
+    }
+    return text;
+}
+
+template <int N>
+bool parseBoard(const string &text, int side, bead::Game<N> &game)
+{
+    if (side != 1 && side != 2)
+        return false;
+    if (text == "start")
+    {
+        game.reset();
+        game.setSideToMove(side);
+        return true;
+    }
+    game.clear();
+    int row = 0, col = 0;
+    for (char c : text)
+    {
+        if (c == '/')
+        {
+            row++;
+            col = 0;
+            continue;
+        }
+        if (!bead::Game<N>::isValid(row, col) || (c != '.' && c != '1' && c != '2'))
+            return false;
+        game.set(row, col++, c == '.' ? 0 : c - '0');
+    }
+    game.setSideToMove(side);
+    return row == N - 1 && col == N;
+}
+
+// The original games' rules on an int per cell, kept apart from the engine.
+// isMovable, isEdible and makeMove are those of the SFML game; the console
+// game's diagonal-only jumps replace the distance check in isEdible.
+template <int N>
+struct ReferenceBoard
+{
+    int board[N][N] = {};
+    int currentPlayer = 1;
+    bool diagonalJumps = false;
+
+    explicit ReferenceBoard(const bead::Game<N> &game)
+        : currentPlayer(game.sideToMove()), diagonalJumps(game.rules().jumpDirections == bead::DIAGONAL_DIRECTIONS)
+    {
+        for (int row = 0; row < N; row++)
+            for (int col = 0; col < N; col++)
+                board[row][col] = game.at(row, col);
+    }
+
+    int at(int row, int col) const
+    {
+        return board[row][col];
+    }
+
+    bool isValid(int row, int col) const
+    {
+        return row >= 0 && col >= 0 && row < N && col < N;
+    }
+
+    bool isEmpty(int row, int col) const
+    {
+        return board[row][col] == 0;
+    }
+
+    static int calculateDistance(int srcRow, int srcCol, int desRow, int desCol)
+    {
+        if ((pow(srcRow - desRow, 2) + pow(srcCol - desCol, 2)) == 5)
+            return 3;
+        return sqrt(pow(srcRow - desRow, 2) + pow(srcCol - desCol, 2));
+    }
+
+    bool isMovable(int player, int srcRow, int srcCol, int desRow, int desCol) const
+    {
+        if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+            return false;
+        if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
+            return false;
+        if (!isEmpty(desRow, desCol))
+            return false;
+        if (calculateDistance(srcRow, srcCol, desRow, desCol) != 1)
+            return false;
+        return true;
+    }
+
+    bool isEdible(int player, int srcRow, int srcCol, int desRow, int desCol) const
+    {
+        if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+            return false;
+        if (isEmpty(srcRow, srcCol) || board[srcRow][srcCol] != player)
+            return false;
+        if (!isEmpty(desRow, desCol))
+            return false;
+        int midRow = (srcRow + desRow) / 2;
+        int midCol = (srcCol + desCol) / 2;
+        if (!isValid(midRow, midCol))
+            return false;
+        int opponent = (player == 1) ? 2 : 1;
+        if (board[midRow][midCol] != opponent)
+            return false;
+        if (diagonalJumps)
+            return abs(srcRow - desRow) == 2 && abs(srcCol - desCol) == 2;
+        return calculateDistance(srcRow, srcCol, desRow, desCol) == 2;
+    }
+
+    bool makeMove(int player, int srcRow, int srcCol, int desRow, int desCol)
+    {
+        if (!isValid(srcRow, srcCol) || !isValid(desRow, desCol))
+            return false;
+        if (board[srcRow][srcCol] != player)
+            return false;
+        if (!isEmpty(desRow, desCol))
+            return false;
+        if (isMovable(player, srcRow, srcCol, desRow, desCol))
+        {
+            board[desRow][desCol] = board[srcRow][srcCol];
+            board[srcRow][srcCol] = 0;
+            return true;
+        }
+        else if (isEdible(player, srcRow, srcCol, desRow, desCol))
+        {
+            int midRow = (srcRow + desRow) / 2;
+            int midCol = (srcCol + desCol) / 2;
+            board[midRow][midCol] = 0;
+            board[desRow][desCol] = board[srcRow][srcCol];
+            board[srcRow][srcCol] = 0;
+            return true;
+        }
+        return false;
+    }
+
+    int countBeads(int player) const
+    {
+        int count = 0;
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                count += board[i][j] == player;
+        return count;
+    }
+
+    // makeMove for the side to move, then the turn passes
+    void play(const bead::Move &move)
+    {
+        makeMove(currentPlayer, move.from / N, move.from % N, move.to / N, move.to % N);
+        currentPlayer = (currentPlayer == 1) ? 2 : 1;
+    }
+};
+
+template <int N>
+bool sameBoard(const ReferenceBoard<N> &reference, const bead::Game<N> &game)
+{
+    if (reference.currentPlayer != game.sideToMove())
+        return false;
+    for (int row = 0; row < N; row++)
+        for (int col = 0; col < N; col++)
+            if (reference.at(row, col) != game.at(row, col))
+                return false;
+    return true;
+}
+
+// Every move for the side to move, found the way the front ends check a
+// click: each pair of cells through isMovable, then isEdible. A player
+// without beads has lost, so the game is over.
+template <int N>
+vector<bead::Move> referenceMoves(const ReferenceBoard<N> &board)
+{
+    vector<bead::Move> moves;
+    if (board.countBeads(1) == 0 || board.countBeads(2) == 0)
+        return moves;
+    int player = board.currentPlayer;
+    for (int src = 0; src < N * N; src++)
+    {
+        if (board.at(src / N, src % N) != player)
+            continue;
+        for (int des = 0; des < N * N; des++)
+        {
+            if (board.isMovable(player, src / N, src % N, des / N, des % N))
+                moves.push_back(bead::Move{uint8_t(src), uint8_t(des), 0});
+            else if (board.isEdible(player, src / N, src % N, des / N, des % N))
+                moves.push_back(bead::Move{uint8_t(src), uint8_t(des), bead::MOVE_CAPTURE});
+        }
+    }
+    return moves;
+}
+
+template <int N>
+vector<bead::Move> fastMoves(const bead::Position<N> &position, unsigned jumpDirections)
+{
+    if (position.count(1) == 0 || position.count(2) == 0)
+        return {};
+    bead::MoveList<N> list;
+    position.generateMoves(list, jumpDirections);
+    return vector<bead::Move>(list.begin(), list.end());
+}
+
+template <int N>
+uint64_t perftReference(const ReferenceBoard<N> &board, int depth)
+{
+    if (depth == 0)
+        return 1;
+    uint64_t nodes = 0;
+    for (const bead::Move &move : referenceMoves(board))
+    {
+        ReferenceBoard<N> child = board;
+        child.play(move);
+        nodes += perftReference(child, depth - 1);
+    }
+    return nodes;
+}
+
+// Bulk counting: the moves at the last ply are counted, not played
+template <int N>
+uint64_t perftFast(bead::Position<N> &position, int depth, unsigned jumpDirections)
+{
+    if (depth == 0)
+        return 1;
+    if (position.count(1) == 0 || position.count(2) == 0)
+        return 0;
+    bead::MoveList<N> moves;
+    position.generateMoves(moves, jumpDirections);
+    if (depth == 1)
+        return uint64_t(moves.size());
+    uint64_t nodes = 0;
+    for (const bead::Move &move : moves)
+    {
+        bead::Undo undo = position.make(move);
+        nodes += perftFast(position, depth - 1, jumpDirections);
+        position.unmake(move, undo);
+    }
+    return nodes;
+}
+
+// Count below each root move, the moves shared out between threads
+template <int N>
+vector<uint64_t> divide(const bead::Game<N> &game, const vector<bead::Move> &roots, int depth, bool reference,
+                        int threads)
+{
+    vector<uint64_t> counts(roots.size());
+    auto count = [&](size_t i) {
+        if (reference)
+        {
+            ReferenceBoard<N> child(game);
+            child.play(roots[i]);
+            counts[i] = perftReference(child, depth - 1);
+        }
+        else
+        {
+            bead::Position<N> child = game.position();
+            child.make(roots[i]);
+            counts[i] = perftFast(child, depth - 1, game.rules().jumpDirections);
+        }
+    };
+
+    if (threads <= 1 || roots.size() < 2)
+    {
+        for (size_t i = 0; i < roots.size(); i++)
+            count(i);
+        return counts;
+    }
+    bead::ThreadPool pool(min(threads, int(roots.size())));
+    for (size_t i = 0; i < roots.size(); i++)
+        pool.submit([&count, i](int) { count(i); });
+    pool.wait();
+    return counts;
+}
+
+bool lessMove(const bead::Move &a, const bead::Move &b)
+{
+    return a.from != b.from ? a.from < b.from : a.to != b.to ? a.to < b.to : a.flags < b.flags;
+}
+
+template <int N>
+void printPath(const vector<bead::Move> &path)
+{
+    if (path.empty())
+        cout << " no moves";
+    for (const bead::Move &move : path)
+        cout << " " << moveName<N>(move);
+}
+
+// Walk the reference board and the engine's game down the first move whose
+// counts differ until their boards or move lists differ, and print where;
+// false if no difference is found
+template <int N>
+bool findDivergence(const ReferenceBoard<N> &board, const bead::Game<N> &game, int depth, vector<bead::Move> &path)
+{
+    if (!sameBoard(board, game))
+    {
+        cout << "Boards differ after";
+        printPath<N>(path);
+        cout << "\nReference: " << boardText(board) << " (player " << board.currentPlayer << " to move)\n";
+        cout << "Fast:      " << boardText(game) << " (player " << game.sideToMove() << " to move)\n";
+        return true;
+    }
+
+    vector<bead::Move> reference = referenceMoves(board);
+    vector<bead::Move> fast = fastMoves(game.position(), game.rules().jumpDirections);
+    sort(reference.begin(), reference.end(), lessMove);
+    sort(fast.begin(), fast.end(), lessMove);
+
+    if (reference != fast)
+    {
+        cout << "Move lists differ after";
+        printPath<N>(path);
+        cout << "\nPosition: " << boardText(game) << " (player " << game.sideToMove() << " to move)\n";
+        vector<bead::Move> only;
+        set_difference(reference.begin(), reference.end(), fast.begin(), fast.end(), back_inserter(only), lessMove);
+        for (const bead::Move &move : only)
+            cout << "  only in reference: " << moveName<N>(move) << "\n";
+        only.clear();
+        set_difference(fast.begin(), fast.end(), reference.begin(), reference.end(), back_inserter(only), lessMove);
+        for (const bead::Move &move : only)
+            cout << "  only in fast: " << moveName<N>(move) << "\n";
+        return true;
+    }
+    if (depth <= 1)
+        return false;
+
+    for (const bead::Move &move : reference)
+    {
+        ReferenceBoard<N> childBoard = board;
+        childBoard.play(move);
+        bead::Game<N> child = game;
+        child.play(move);
+        bead::Position<N> position = child.position();
+        if (sameBoard(childBoard, child) &&
+            perftReference(childBoard, depth - 1) == perftFast(position, depth - 1, game.rules().jumpDirections))
+            continue;
+        path.push_back(move);
+        if (findDivergence(childBoard, child, depth - 1, path))
+            return true;
+        path.pop_back();
+    }
+    return false;
+}
+
+// Count with one generator, print the result and return the total
+template <int N>
+uint64_t countNodes(const Options &options, const bead::Game<N> &game, bool reference)
+{
+    vector<bead::Move> roots = reference ? referenceMoves(ReferenceBoard<N>(game))
+                                         : fastMoves(game.position(), game.rules().jumpDirections);
+    auto start = Clock::now();
+    vector<uint64_t> counts = divide(game, roots, options.depth, reference, options.threads);
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < roots.size(); i++)
+    {
+        nodes += counts[i];
+        if (options.divide)
+            cout << "  " << moveName<N>(roots[i]) << ": " << counts[i] << "\n";
+    }
+    cout << (reference ? "Reference" : "Fast") << ": " << nodes << " nodes in " << fixed << setprecision(3)
+         << seconds << " s, " << setprecision(0) << (seconds > 0 ? nodes / seconds : 0) << " nodes/s" << endl;
+    return nodes;
+}
+
+template <int N>
+int run(const Options &options)
+{
+    bead::Game<N> game(options.rules);
+    if (!parseBoard(options.board, options.side, game))
+    {
+        cerr << "Not a " << N << "x" << N << " board: " << options.board << "\n";
+        return 1;
+    }
+    cout << N << "x" << N << " " << boardText(game) << ", player " << game.sideToMove() << " to move, depth "
+         << options.depth << "\n";
+
+    if (options.mode == "fast")
+        countNodes(options, game, false);
+    else if (options.mode == "reference")
+        countNodes(options, game, true);
+    else
+    {
+        uint64_t fast = countNodes(options, game, false);
+        uint64_t reference = countNodes(options, game, true);
+        if (fast != reference)
+        {
+            vector<bead::Move> path;
+            if (!findDivergence(ReferenceBoard<N>(game), game, options.depth, path))
+                cout << "Counts differ but no differing move list was found\n";
+            return 1;
+        }
+        cout << "Counts match\n";
+    }
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: perft [--depth D] [--size 4|5|6|8|10] [--board BOARD] [--side 1|2]\n"
+            "             [--mode fast|reference|check] [--threads T] [--divide]\n"
+            "             [--diagonal]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--diagonal")
+        {
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            continue;
+        }
+        if (arg == "--divide")
+        {
+            options.divide = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--depth")
+            options.depth = atoi(value.c_str());
+        else if (arg == "--size")
+            options.size = atoi(value.c_str());
+        else if (arg == "--board")
+            options.board = value;
+        else if (arg == "--side")
+            options.side = atoi(value.c_str());
+        else if (arg == "--mode")
+            options.mode = value;
+        else if (arg == "--threads")
+            options.threads = atoi(value.c_str());
+        else
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+    if (options.depth <= 0 || options.threads <= 0 ||
+        (options.mode != "fast" && options.mode != "reference" && options.mode != "check"))
+    {
+        usage();
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
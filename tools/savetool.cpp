@@ -0,0 +1,288 @@
+// Converter between binary saved games and text.
+//
+// Build: g++ -std=c++17 -O2 tools/savetool.cpp -o savetool
+// Usage: savetool export SAVE [TEXT]
+//        savetool import [--diagonal] [--chains] TEXT SAVE
+//
+// The text starts with the side to move and the current grid, one row per
+// line, as the old saved_game.txt did; a bare grid, as in the old
+// board_save.txt, is read with player 1 to move. Export adds the rest of
+// the save after the grid:
+//   time MS                   left on the side to move's turn clock
+//   start SIDE                the position the history starts from,
+//   <grid>                    followed by its grid
+//   moves COUNT               then one move per line: "SR SC DR DC" or "pass";
+//                             a jump with a "+" after it is part of a
+//                             capture chain the same bead goes on with
+// Import checks the moves are legal and lead to the current grid. Without
+// a history the current grid becomes the start of the saved game. Use
+// --diagonal for saves of the 4x4 console game, whose jumps are diagonal,
+// and --chains for games played with capture chains.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+using namespace std;
+
+template <int N>
+void writeGrid(ostream &out, const bead::Position<N> &position)
+{
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+            out << position.at(i, j) << " ";
+        out << "\n";
+    }
+}
+
+template <int N>
+int exportText(const vector<uint8_t> &bytes, const bead::SaveHeader &header, ostream &out)
+{
+    bead::Game<N> game(bead::Rules{header.jumpDirections, header.captureChains != 0});
+    int timeRemainingMs = 0;
+    bead::SaveStatus status = bead::decodeSave(bytes.data(), bytes.size(), game, timeRemainingMs);
+    if (status != bead::SAVE_OK)
+    {
+        cerr << "Invalid save: " << bead::saveStatusText(status) << "\n";
+        return 1;
+    }
+
+    out << game.sideToMove() << "\n";
+    writeGrid(out, game.position());
+    out << "time " << timeRemainingMs << "\n";
+    out << "start " << game.startPosition().sideToMove() << "\n";
+    writeGrid(out, game.startPosition());
+    out << "moves " << game.history().size() << "\n";
+    for (const bead::Move &move : game.history())
+    {
+        if (move.isPass())
+            out << "pass\n";
+        else
+            out << move.from / N << " " << move.from % N << " " << move.to / N << " " << move.to % N
+                << (move.continues() ? " +" : "") << "\n";
+    }
+    return 0;
+}
+
+// Read a grid of N * N cells into game
+template <int N>
+bool readGrid(const vector<int> &cells, size_t first, bead::Game<N> &game)
+{
+    game.clear();
+    for (int i = 0; i < N * N; i++)
+    {
+        int cell = cells[first + i];
+        if (cell < 0 || cell > 2)
+            return false;
+        game.set(i / N, i % N, cell);
+    }
+    return true;
+}
+
+template <int N>
+int importText(const vector<int> &numbers, istream &in, const bead::Rules &rules, const string &path)
+{
+    // Current position: side to move and grid, or a bare grid
+    bead::Game<N> current(rules);
+    bool hasSide = numbers.size() == size_t(N * N + 1);
+    int side = hasSide ? numbers[0] : 1;
+    if ((side != 1 && side != 2) || !readGrid(numbers, hasSide ? 1 : 0, current))
+    {
+        cerr << "Invalid grid\n";
+        return 1;
+    }
+    current.setSideToMove(side);
+
+    int timeRemainingMs = 30 * 1000;
+    bead::Game<N> game = current;
+    string word;
+    while (in >> word)
+    {
+        if (word == "time")
+            in >> timeRemainingMs;
+        else if (word == "start")
+        {
+            vector<int> start(N * N);
+            int startSide = 0;
+            in >> startSide;
+            for (int &cell : start)
+                in >> cell;
+            if (!in || (startSide != 1 && startSide != 2) || !readGrid(start, 0, game))
+            {
+                cerr << "Invalid start grid\n";
+                return 1;
+            }
+            game.setSideToMove(startSide);
+        }
+        else if (word == "moves")
+        {
+            size_t count = 0;
+            in >> count;
+            for (size_t m = 0; m < count; m++)
+            {
+                string first;
+                in >> first;
+                if (first == "pass")
+                {
+                    if (!bead::replayMove(game, bead::Move{0, 0, bead::MOVE_PASS}))
+                    {
+                        cerr << "Illegal move " << m + 1 << ": pass inside a capture chain\n";
+                        return 1;
+                    }
+                    continue;
+                }
+                int srcRow = atoi(first.c_str()), srcCol, desRow, desCol;
+                string rest;
+                in >> srcCol >> desRow >> desCol;
+                getline(in, rest); // "+" when the chain goes on
+                bool valid = in && bead::Game<N>::isValid(srcRow, srcCol) && bead::Game<N>::isValid(desRow, desCol);
+                bead::Move move{uint8_t(srcRow * N + srcCol), uint8_t(desRow * N + desCol), 0};
+                if (valid && game.isEdible(game.sideToMove(), srcRow, srcCol, desRow, desCol))
+                    move.flags = bead::MOVE_CAPTURE;
+                if (rest.find('+') != string::npos)
+                    move.flags |= bead::MOVE_CONTINUES;
+                if (!valid || !bead::replayMove(game, move))
+                {
+                    cerr << "Illegal move " << m + 1 << ": " << first << " " << srcCol << " " << desRow << " "
+                         << desCol << rest << "\n";
+                    return 1;
+                }
+            }
+            if (!game.history().empty() && game.history().back().continues())
+            {
+                cerr << "The moves end inside a capture chain\n";
+                return 1;
+            }
+        }
+        else
+        {
+            cerr << "Unexpected \"" << word << "\"\n";
+            return 1;
+        }
+        if (!in)
+        {
+            cerr << "Truncated text after \"" << word << "\"\n";
+            return 1;
+        }
+    }
+    if (game.position().key() != current.position().key())
+    {
+        cerr << "The moves do not lead to the grid at the top of the file\n";
+        return 1;
+    }
+
+    bead::SaveStatus status = bead::writeSaveFile(path, game, timeRemainingMs);
+    if (status != bead::SAVE_OK)
+    {
+        cerr << "Error writing " << path << ": " << bead::saveStatusText(status) << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int exportSave(const string &savePath, const string &textPath)
+{
+    ifstream file(savePath, ios::binary);
+    vector<uint8_t> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (!file.is_open() || bytes.size() < sizeof(bead::SaveHeader))
+    {
+        cerr << "Could not read " << savePath << "\n";
+        return 1;
+    }
+    bead::SaveHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+
+    ofstream textFile;
+    if (!textPath.empty())
+    {
+        textFile.open(textPath);
+        if (!textFile)
+        {
+            cerr << "Could not write " << textPath << "\n";
+            return 1;
+        }
+    }
+    ostream &out = textPath.empty() ? cout : textFile;
+    switch (header.size)
+    {
+    case 4:
+        return exportText<4>(bytes, header, out);
+    case 5:
+        return exportText<5>(bytes, header, out);
+    case 6:
+        return exportText<6>(bytes, header, out);
+    case 8:
+        return exportText<8>(bytes, header, out);
+    case 10:
+        return exportText<10>(bytes, header, out);
+    }
+    cerr << "Unsupported grid size " << int(header.size) << "\n";
+    return 1;
+}
+
+int importSave(const string &textPath, const string &savePath, const bead::Rules &rules)
+{
+    ifstream file(textPath);
+    if (!file)
+    {
+        cerr << "Could not read " << textPath << "\n";
+        return 1;
+    }
+
+    // The leading numbers are the grid, with the side to move first or not;
+    // their count gives the grid size
+    vector<int> numbers;
+    int number;
+    while (file >> number)
+        numbers.push_back(number);
+    file.clear();
+
+    if (numbers.size() == 4 * 4 || numbers.size() == 4 * 4 + 1)
+        return importText<4>(numbers, file, rules, savePath);
+    if (numbers.size() == 5 * 5 || numbers.size() == 5 * 5 + 1)
+        return importText<5>(numbers, file, rules, savePath);
+    if (numbers.size() == 6 * 6 || numbers.size() == 6 * 6 + 1)
+        return importText<6>(numbers, file, rules, savePath);
+    if (numbers.size() == 8 * 8 || numbers.size() == 8 * 8 + 1)
+        return importText<8>(numbers, file, rules, savePath);
+    if (numbers.size() == 10 * 10 || numbers.size() == 10 * 10 + 1)
+        return importText<10>(numbers, file, rules, savePath);
+    cerr << "Expected a 4x4, 5x5, 6x6, 8x8 or 10x10 grid, found " << numbers.size() << " numbers\n";
+    return 1;
+}
+
+void usage()
+{
+    cerr << "usage: savetool export SAVE [TEXT]\n"
+            "       savetool import [--diagonal] [--chains] TEXT SAVE\n";
+}
+
+int main(int argc, char **argv)
+{
+    vector<string> args(argv + 1, argv + argc);
+    bead::Rules rules;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        if (args[i] == "--diagonal")
+        {
+            rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+            args.erase(args.begin() + i--);
+        }
+        else if (args[i] == "--chains")
+        {
+            rules.captureChains = true;
+            args.erase(args.begin() + i--);
+        }
+    }
+
+    if (args.size() >= 2 && args.size() <= 3 && args[0] == "export")
+        return exportSave(args[1], args.size() == 3 ? args[2] : "");
+    if (args.size() == 3 && args[0] == "import")
+        return importSave(args[1], args[2], rules);
+    usage();
+    return 1;
+}
@@ -0,0 +1,120 @@
+// Time-to-depth speedup of the multithreaded search.
+//
+// Build: g++ -std=c++17 -O2 -pthread tools/smp_speedup.cpp -o smp_speedup
+// Usage: smp_speedup [--depth D] [--positions P] [--threads 1,2,4,8] [--hash MB]
+//
+// Searches a fixed set of positions (the starting setup and positions
+// reached by seeded random play) to depth D with each thread count, and
+// reports total time, nodes/s and the speedup over one thread. Every run
+// starts from an empty table, so the numbers do not depend on run order.
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+using namespace std;
+
+const int GRID_SIZE = 6;
+using BeadGame = bead::Game<GRID_SIZE>;
+
+// The same positions on every run: random legal play from a fixed seed
+vector<bead::Position<GRID_SIZE>> buildPositions(int count)
+{
+    vector<bead::Position<GRID_SIZE>> positions;
+    uint64_t state = 12345;
+    while (int(positions.size()) < count)
+    {
+        BeadGame game;
+        int plies = int(positions.size()) * 3;
+        bool ended = false;
+        for (int i = 0; i < plies && !ended; i++)
+        {
+            bead::MoveList<GRID_SIZE> moves;
+            game.generateMoves(moves);
+            if (moves.empty())
+            {
+                ended = true;
+                break;
+            }
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            game.play(moves[(state >> 33) % moves.size()]);
+        }
+        if (!ended && game.winner() == 0)
+            positions.push_back(game.position());
+    }
+    return positions;
+}
+
+int main(int argc, char **argv)
+{
+    int depth = 9;
+    int positionCount = 8;
+    size_t hashMB = 64;
+    vector<int> threadCounts = {1, 2, 4, 8};
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        string arg = argv[i];
+        string value = argv[i + 1];
+        if (arg == "--depth")
+            depth = atoi(value.c_str());
+        else if (arg == "--positions")
+            positionCount = atoi(value.c_str());
+        else if (arg == "--hash")
+            hashMB = atol(value.c_str());
+        else if (arg == "--threads")
+        {
+            threadCounts.clear();
+            stringstream list(value);
+            string item;
+            while (getline(list, item, ','))
+                threadCounts.push_back(atoi(item.c_str()));
+        }
+        else
+        {
+            cerr << "usage: smp_speedup [--depth D] [--positions P] [--threads 1,2,4,8] [--hash MB]\n";
+            return 1;
+        }
+    }
+
+    vector<bead::Position<GRID_SIZE>> positions = buildPositions(positionCount);
+    cout << positions.size() << " positions, depth " << depth << ", " << thread::hardware_concurrency()
+         << " hardware threads\n";
+    cout << "threads      time(s)        nodes      nodes/s  speedup  same move\n";
+
+    bead::Searcher<GRID_SIZE> searcher(hashMB);
+    bead::SearchLimits limits;
+    limits.maxDepth = depth;
+
+    double baseline = 0;
+    vector<bead::Move> baselineMoves;
+    for (int threads : threadCounts)
+    {
+        searcher.setThreads(threads);
+        double seconds = 0;
+        uint64_t nodes = 0;
+        int sameMove = 0;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            searcher.clearHistory();
+            bead::SearchResult result = searcher.search(positions[i], limits);
+            seconds += result.seconds;
+            nodes += result.nodes;
+            if (baselineMoves.size() < positions.size())
+                baselineMoves.push_back(result.best);
+            if (result.best == baselineMoves[i])
+                sameMove++;
+        }
+        if (baseline == 0)
+            baseline = seconds;
+
+        cout << setw(7) << threads << fixed << setprecision(3) << setw(13) << seconds << setw(13) << nodes
+             << setw(13) << uint64_t(seconds > 0 ? nodes / seconds : 0) << setprecision(2) << setw(9)
+             << (seconds > 0 ? baseline / seconds : 0) << setw(7) << sameMove << "/" << positions.size() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,422 @@
+// Endgame tablebase generator (retrograde analysis).
+//
+// Build: g++ -std=c++17 -O2 tools/tbgen.cpp -o tbgen
+// Usage: tbgen [--beads K] [--size 4|5|6|8|10] [--diagonal] [--out FILE]
+//
+// Solves every position of the grid size (default 6x6) with at most K
+// beads (default 4) and writes the tables in the format described in
+// engine/tablebase.h, to bead<size>.tb unless --out names another file.
+// --diagonal builds tables for the diagonal-jump variant instead.
+//
+// Classes are solved in order of total bead count, since a capture always
+// leads to a class with fewer beads. Steps keep the bead counts, swapping
+// the roles of the two sides, so the classes (a, b) and (b, a) are solved
+// together. A pass over every position seeds the known results: positions
+// without moves, wins by capture, and losses where every move leads to an
+// opponent win. Results then spread backwards through un-played steps,
+// one distance at a time. Whatever is still unknown at the end is a draw.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+#include "../engine/tablebase.h"
+using namespace std;
+
+struct Options
+{
+    int maxBeads = 4;
+    int size = 6;
+    bead::Rules rules;
+    string out; // bead<size>.tb when empty
+};
+
+// Solved entries, by (us, them), in file encoding
+vector<uint8_t> solved[bead::TB_MAX_BEADS + 1][bead::TB_MAX_BEADS + 1];
+
+// Expand a colex-ordered subset of the free cells into board cells
+template <int N>
+typename bead::BitBoard<N>::Mask expand(typename bead::BitBoard<N>::Mask compact,
+                                        typename bead::BitBoard<N>::Mask occupied)
+{
+    using Board = bead::BitBoard<N>;
+    typename Board::Mask result = 0;
+    int slot = 0;
+    for (int sq = 0; sq < Board::CELLS && compact; sq++)
+    {
+        if (occupied & Board::bit(sq))
+            continue;
+        if (compact & 1)
+            result |= Board::bit(sq);
+        compact >>= 1;
+        slot++;
+    }
+    return result;
+}
+
+// Next set with the same number of bits (Gosper's hack); colex order
+template <typename Mask>
+Mask nextSubset(Mask set)
+{
+    Mask lowest = set & (~set + 1);
+    Mask ripple = set + lowest;
+    return (((ripple ^ set) >> 2) / lowest) | ripple;
+}
+
+// Call visit(set) for every set of k of the first n cells, in colex order.
+// The last set is the top k cells; stopping there keeps the masks from
+// overflowing when n is their full width.
+template <typename Mask, typename Visit>
+void forEachSubset(int k, int n, Visit visit)
+{
+    if (k == 0)
+    {
+        visit(Mask(0));
+        return;
+    }
+    Mask last = ((Mask(1) << k) - 1) << (n - k);
+    for (Mask set = (Mask(1) << k) - 1;; set = nextSubset(set))
+    {
+        visit(set);
+        if (set == last)
+            break;
+    }
+}
+
+// Call visit(index, us, them) for every position of a class in index order
+template <int N, typename Visit>
+void forEachPosition(int us, int them, Visit visit)
+{
+    using Mask = typename bead::BitBoard<N>::Mask;
+    uint64_t index = 0;
+    forEachSubset<Mask>(us, N * N, [&](Mask ourSet) {
+        forEachSubset<Mask>(them, N * N - us, [&](Mask compact) {
+            visit(index++, ourSet, expand<N>(compact, ourSet));
+        });
+    });
+}
+
+// One class being solved: per-position working state
+struct Table
+{
+    int us = 0, them = 0;
+    uint64_t size = 0;
+    vector<uint16_t> distance;  // 0 unknown, else distance + 1
+    vector<uint8_t> remaining;  // steps not yet known to lose
+    vector<uint16_t> lossFloor; // longest loss forced by a capture seen so far
+    vector<uint8_t> flags;
+};
+
+const uint8_t HAS_DRAW = 1;       // a capture leads to a draw
+const uint8_t HAS_WIN = 2;        // a capture wins; only the distance is open
+const uint8_t PROPAGATED = 4;     // predecessors have been updated
+
+struct Item
+{
+    uint32_t table;
+    uint64_t index;
+};
+
+template <int N>
+int run(const Options &options)
+{
+    using Board = bead::BitBoard<N>;
+    using Geometry = bead::Geometry<N>;
+    using Index = bead::TBIndex<N>;
+    using Mask = typename Board::Mask;
+    const int CELLS = Board::CELLS;
+    const int maxBeads = options.maxBeads;
+    const bead::Rules &rules = options.rules;
+    string out = options.out.empty() ? "bead" + to_string(N) + ".tb" : options.out;
+
+    for (int total = 2; total <= maxBeads; total++)
+    {
+        for (int a = 1; a <= total / 2; a++)
+        {
+            int b = total - a;
+            vector<Table> tables(a == b ? 1 : 2);
+            tables[0].us = a;
+            tables[0].them = b;
+            if (a != b)
+            {
+                tables[1].us = b;
+                tables[1].them = a;
+            }
+            auto tableOf = [&](int us) { return tables[0].us == us ? 0u : 1u; };
+
+            for (Table &t : tables)
+            {
+                t.size = Index::classSize(t.us, t.them);
+                t.distance.assign(t.size, 0);
+                t.remaining.assign(t.size, 0);
+                t.lossFloor.assign(t.size, 0);
+                t.flags.assign(t.size, 0);
+            }
+
+            // Seed: results that do not depend on other positions of this class
+            vector<vector<Item>> buckets(1);
+            auto push = [&](int distance, Item item) {
+                if (int(buckets.size()) <= distance)
+                    buckets.resize(distance + 1);
+                buckets[distance].push_back(item);
+            };
+
+            for (uint32_t ti = 0; ti < tables.size(); ti++)
+            {
+                Table &t = tables[ti];
+                forEachPosition<N>(t.us, t.them, [&](uint64_t index, Mask us, Mask them) {
+                    Board board;
+                    board.beads[0] = us;
+                    board.beads[1] = them;
+                    bead::MoveList<N> moves;
+                    bead::generateMoves(board, 1, moves, rules.jumpDirections);
+                    if (moves.empty())
+                    {
+                        t.distance[index] = 1; // blocked: lost now
+                        push(0, Item{ti, index});
+                        return;
+                    }
+
+                    int bestWin = 0;
+                    for (const bead::Move &move : moves)
+                    {
+                        if (!move.isCapture())
+                            continue;
+                        // After a capture the opponent moves with one bead fewer
+                        Mask ourAfter = us ^ Board::bit(move.from) ^ Board::bit(move.to);
+                        Mask theirAfter = them & ~Board::bit(Geometry::middle(move.from, move.to));
+                        bead::TBResult child;
+                        if (t.them == 1)
+                            child.value = bead::TB_LOSS; // no beads left
+                        else
+                            child = bead::decodeTB(solved[t.them - 1][t.us][Index::index(theirAfter, ourAfter)]);
+
+                        if (child.value == bead::TB_LOSS)
+                        {
+                            if (bestWin == 0 || child.distance + 1 < bestWin)
+                                bestWin = child.distance + 1;
+                        }
+                        else if (child.value == bead::TB_WIN)
+                            t.lossFloor[index] = max<int>(t.lossFloor[index], child.distance + 1);
+                        else
+                            t.flags[index] |= HAS_DRAW;
+                    }
+
+                    int steps = moves.size() - moves.captures;
+                    t.remaining[index] = uint8_t(steps);
+                    if (bestWin)
+                    {
+                        t.flags[index] |= HAS_WIN;
+                        push(bestWin, Item{ti, index});
+                    }
+                    else if (steps == 0 && !(t.flags[index] & HAS_DRAW))
+                    {
+                        t.distance[index] = uint16_t(t.lossFloor[index] + 1);
+                        push(t.lossFloor[index], Item{ti, index});
+                    }
+                });
+            }
+
+            // Retrograde: settle positions in order of distance and update
+            // the positions one step before them
+            for (size_t d = 0; d < buckets.size(); d++)
+            {
+                for (size_t k = 0; k < buckets[d].size(); k++)
+                {
+                    Item item = buckets[d][k];
+                    Table &t = tables[item.table];
+                    uint64_t index = item.index;
+                    if (t.distance[index] == 0)
+                        t.distance[index] = uint16_t(d + 1); // a capture win nothing beat
+                    if (t.distance[index] != d + 1 || (t.flags[index] & PROPAGATED))
+                        continue;
+                    t.flags[index] |= PROPAGATED;
+                    bool lost = d % 2 == 0;
+
+                    // Recover the masks of this position from its index
+                    uint64_t freeCount = Index::choose(CELLS - t.us, t.them);
+                    uint64_t ourRank = index / freeCount, theirRank = index % freeCount;
+                    Mask us = 0, them = 0;
+                    {
+                        uint64_t r = ourRank;
+                        for (int i = t.us; i >= 1; i--)
+                        {
+                            int sq = i - 1;
+                            while (Index::choose(sq + 1, i) <= r)
+                                sq++;
+                            r -= Index::choose(sq, i);
+                            us |= Board::bit(sq);
+                        }
+                        r = theirRank;
+                        Mask compact = 0;
+                        for (int i = t.them; i >= 1; i--)
+                        {
+                            int sq = i - 1;
+                            while (Index::choose(sq + 1, i) <= r)
+                                sq++;
+                            r -= Index::choose(sq, i);
+                            compact |= Board::bit(sq);
+                        }
+                        them = expand<N>(compact, us);
+                    }
+
+                    // The opponent's last move was a step from an empty neighbour
+                    Mask empty = ~(us | them) & Board::FULL;
+                    uint32_t prevTable = tableOf(t.them);
+                    Table &p = tables[prevTable];
+                    for (Mask movers = them; movers; movers &= movers - 1)
+                    {
+                        int to = bead::lowestBit(movers);
+                        for (Mask froms = Geometry::TABLES.steps[to] & empty; froms; froms &= froms - 1)
+                        {
+                            int from = bead::lowestBit(froms);
+                            Mask before = them ^ Board::bit(to) ^ Board::bit(from);
+                            uint64_t prev = Index::index(before, us);
+                            if (p.distance[prev] != 0)
+                                continue;
+                            if (lost)
+                            {
+                                p.distance[prev] = uint16_t(d + 2);
+                                push(int(d + 1), Item{prevTable, prev});
+                            }
+                            else if (--p.remaining[prev] == 0 && !(p.flags[prev] & (HAS_DRAW | HAS_WIN)))
+                            {
+                                int distance = max<int>(p.lossFloor[prev], int(d + 1));
+                                p.distance[prev] = uint16_t(distance + 1);
+                                push(distance, Item{prevTable, prev});
+                            }
+                        }
+                    }
+                }
+                vector<Item>().swap(buckets[d]);
+            }
+
+            for (Table &t : tables)
+            {
+                vector<uint8_t> &entries = solved[t.us][t.them];
+                entries.resize(t.size);
+                uint64_t wins = 0, losses = 0, draws = 0;
+                int longest = 0;
+                for (uint64_t i = 0; i < t.size; i++)
+                {
+                    if (t.distance[i] > 255)
+                    {
+                        cerr << "distance " << t.distance[i] - 1 << " does not fit the table format\n";
+                        return 1;
+                    }
+                    entries[i] = uint8_t(t.distance[i]);
+                    bead::TBResult r = bead::decodeTB(entries[i]);
+                    if (r.value == bead::TB_WIN)
+                        wins++;
+                    else if (r.value == bead::TB_LOSS)
+                        losses++;
+                    else
+                        draws++;
+                    longest = max(longest, r.distance);
+                }
+                printf("%d vs %d: %llu positions, %llu wins, %llu losses, %llu draws, longest %d plies\n", t.us,
+                       t.them, (unsigned long long)t.size, (unsigned long long)wins, (unsigned long long)losses,
+                       (unsigned long long)draws, longest);
+            }
+        }
+    }
+
+    // Write header, class directory and entries
+    vector<bead::TBClass> classes;
+    uint64_t offset = 0;
+    for (int total = 2; total <= maxBeads; total++)
+    {
+        for (int us = 1; us < total; us++)
+        {
+            bead::TBClass entry;
+            entry.us = uint8_t(us);
+            entry.them = uint8_t(total - us);
+            entry.count = solved[us][total - us].size();
+            entry.offset = offset;
+            offset += entry.count;
+            classes.push_back(entry);
+        }
+    }
+    bead::TBHeader header;
+    header.size = N;
+    header.maxBeads = uint8_t(maxBeads);
+    header.jumpDirections = rules.jumpDirections;
+    header.classCount = uint32_t(classes.size());
+    uint64_t dataStart = sizeof(header) + classes.size() * sizeof(bead::TBClass);
+    for (bead::TBClass &entry : classes)
+        entry.offset += dataStart;
+
+    FILE *file = fopen(out.c_str(), "wb");
+    if (!file)
+    {
+        cerr << "Error writing " << out << "\n";
+        return 1;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(classes.data(), sizeof(bead::TBClass), classes.size(), file) == classes.size();
+    for (const bead::TBClass &entry : classes)
+    {
+        const vector<uint8_t> &entries = solved[entry.us][entry.them];
+        ok = ok && fwrite(entries.data(), 1, entries.size(), file) == entries.size();
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        cerr << "Error writing " << out << "\n";
+        return 1;
+    }
+    printf("Wrote %s: %llu bytes\n", out.c_str(), (unsigned long long)(dataStart + offset));
+    return 0;
+}
+
+void usage()
+{
+    cerr << "usage: tbgen [--beads K] [--size 4|5|6|8|10] [--diagonal] [--out FILE]\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--beads" && i + 1 < argc)
+            options.maxBeads = atoi(argv[++i]);
+        else if (arg == "--size" && i + 1 < argc)
+            options.size = atoi(argv[++i]);
+        else if (arg == "--diagonal")
+            options.rules.jumpDirections = bead::DIAGONAL_DIRECTIONS;
+        else if (arg == "--out" && i + 1 < argc)
+            options.out = argv[++i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (options.maxBeads < 2 || options.maxBeads > bead::TB_MAX_BEADS)
+    {
+        cerr << "bead count must be between 2 and " << bead::TB_MAX_BEADS << "\n";
+        return 1;
+    }
+
+    switch (options.size)
+    {
+    case 4:
+        return run<4>(options);
+    case 5:
+        return run<5>(options);
+    case 6:
+        return run<6>(options);
+    case 8:
+        return run<8>(options);
+    case 10:
+        return run<10>(options);
+    }
+    cerr << "Unsupported size " << options.size << "\n";
+    return 1;
+}
@@ -0,0 +1,328 @@
+// Headless self-play tournament between two computer players.
+//
+// Build: g++ -std=c++17 -O2 -pthread tools/tournament.cpp -o tournament
+// Usage: tournament [--games N] [--threads T] [--a PLAYER] [--b PLAYER]
+//                   [--openings PLIES] [--max-plies PLIES] [--hash MB]
+//                   [--seed S] [--out FILE]
+//
+// PLAYER is "random" (the GUI's capture-if-possible random move) or
+// "depth:D" (alpha-beta search to a fixed depth D). A search player may add
+// evaluation weights, "depth:D:MATERIAL,MOBILITY,THREATS,CENTRE,BACKROW"
+// (see engine/eval.h); "depth:4:100,0,0,0,0" counts material only. Games
+// are played in pairs from the same random opening with colours swapped,
+// so neither player gains from the opening or from moving first. Results
+// are from player A's point of view.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../engine/engine.h"
+#include "../engine/thread_pool.h"
+using namespace std;
+
+const int GRID_SIZE = 6;
+using BeadGame = bead::Game<GRID_SIZE>;
+using Searcher = bead::Searcher<GRID_SIZE>;
+
+struct PlayerSpec
+{
+    string name;
+    int depth = 0; // 0 plays the random policy
+    bead::EvalWeights weights;
+};
+
+struct Options
+{
+    long games = 1000;
+    int threads = 0;
+    PlayerSpec a{"random", 0, {}};
+    PlayerSpec b{"depth:2", 2, {}};
+    int openings = 4;   // random plies played before the players take over
+    int maxPlies = 200; // longer games are drawn
+    size_t hashMB = 1;
+    uint64_t seed = 1;
+    string out;
+};
+
+// Per-game random numbers; cheap and reproducible from the game's seed
+struct Random
+{
+    uint64_t state;
+
+    unsigned next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return unsigned((z ^ (z >> 31)) >> 32);
+    }
+};
+
+// Searchers are large, so each worker keeps one per player for all its games
+struct WorkerState
+{
+    unique_ptr<Searcher> searchers[2];
+};
+
+struct Totals
+{
+    atomic<long> wins{0}, draws{0}, losses{0};
+    atomic<long> winsAsFirst{0}, gamesAsFirst{0};
+    atomic<long> plies{0};
+};
+
+bool parsePlayer(const string &text, PlayerSpec &player)
+{
+    player.name = text;
+    if (text == "random")
+    {
+        player.depth = 0;
+        return true;
+    }
+    if (text.compare(0, 6, "depth:") == 0)
+    {
+        player.depth = atoi(text.c_str() + 6);
+        size_t colon = text.find(':', 6);
+        if (colon != string::npos)
+        {
+            bead::EvalWeights &w = player.weights;
+            char end = 0;
+            if (sscanf(text.c_str() + colon + 1, "%d,%d,%d,%d,%d%c", &w.material, &w.mobility, &w.threats,
+                       &w.centre, &w.backRow, &end) != 5)
+                return false;
+        }
+        return player.depth > 0 && player.depth < bead::MAX_PLY;
+    }
+    return false;
+}
+
+bead::Move chooseMove(BeadGame &game, const PlayerSpec &player, Searcher *searcher,
+                      const bead::MoveList<GRID_SIZE> &moves, Random &random)
+{
+    if (player.depth == 0)
+        return bead::randomMove(moves, random.next());
+
+    bead::SearchLimits limits;
+    limits.maxDepth = player.depth;
+    return searcher->search(game.position(), limits, game.rules()).best;
+}
+
+// Play one game; returns the winner (1 or 2) or 0 for a draw
+int playGame(const Options &options, const PlayerSpec *players[2], Searcher *searchers[2],
+             uint64_t seed, long &plies)
+{
+    BeadGame game;
+    Random random{seed};
+    bead::MoveList<GRID_SIZE> moves;
+
+    for (plies = 0; plies < options.maxPlies; plies++)
+    {
+        int player = game.sideToMove();
+        // No beads, or no way to move them, loses the game
+        if (game.position().count(player) == 0)
+            return 3 - player;
+        game.generateMoves(moves);
+        if (moves.empty())
+            return 3 - player;
+
+        bead::Move move;
+        if (plies < options.openings)
+            move = moves[random.next() % moves.size()];
+        else
+            move = chooseMove(game, *players[player - 1], searchers[player - 1], moves, random);
+        game.play(move);
+    }
+    return 0;
+}
+
+// Wilson score interval for a proportion, 95% confidence
+void wilson(long hits, long n, double &low, double &high)
+{
+    const double z = 1.96;
+    if (n == 0)
+    {
+        low = 0;
+        high = 1;
+        return;
+    }
+    double p = double(hits) / n;
+    double denominator = 1 + z * z / n;
+    double centre = (p + z * z / (2 * n)) / denominator;
+    double spread = z * sqrt(p * (1 - p) / n + z * z / (4.0 * n * n)) / denominator;
+    low = max(0.0, centre - spread);
+    high = min(1.0, centre + spread);
+}
+
+double eloFromScore(double score)
+{
+    score = min(max(score, 1e-6), 1 - 1e-6);
+    return -400 * log10(1 / score - 1);
+}
+
+string report(const Options &options, const Totals &totals, double seconds)
+{
+    long wins = totals.wins, draws = totals.draws, losses = totals.losses;
+    long n = wins + draws + losses;
+
+    ostringstream out;
+    out << fixed << setprecision(1);
+    out << "Player A: " << options.a.name << "\n";
+    out << "Player B: " << options.b.name << "\n";
+    out << "Games: " << n << " (" << options.openings << " random opening plies, draw after "
+        << options.maxPlies << " plies)\n";
+
+    const char *labels[3] = {"Wins", "Draws", "Losses"};
+    long counts[3] = {wins, draws, losses};
+    for (int i = 0; i < 3; i++)
+    {
+        double low, high;
+        wilson(counts[i], n, low, high);
+        out << labels[i] << ": " << counts[i] << " (" << (n ? 100.0 * counts[i] / n : 0)
+            << "%, 95% CI " << 100 * low << "% - " << 100 * high << "%)\n";
+    }
+
+    if (n > 0)
+    {
+        // Score per game is 1, 0.5 or 0; normal approximation of its mean
+        double score = (wins + 0.5 * draws) / n;
+        double variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) +
+                           losses * score * score) / n;
+        double margin = 1.96 * sqrt(variance / n);
+        out << "Score: " << 100 * score << "% +/- " << 100 * margin << "%\n";
+        out << "Elo difference: " << eloFromScore(score) << " (95% CI " << eloFromScore(score - margin)
+            << " to " << eloFromScore(score + margin) << ")\n";
+        out << "A wins as player 1: " << totals.winsAsFirst << " of " << totals.gamesAsFirst << "\n";
+    }
+
+    out << setprecision(2) << "Time: " << seconds << " s, " << (seconds > 0 ? n / seconds : 0)
+        << " games/s, " << (seconds > 0 ? totals.plies / seconds : 0) << " plies/s\n";
+    return out.str();
+}
+
+void usage()
+{
+    cerr << "usage: tournament [--games N] [--threads T] [--a PLAYER] [--b PLAYER]\n"
+            "                  [--openings PLIES] [--max-plies PLIES] [--hash MB]\n"
+            "                  [--seed S] [--out FILE]\n"
+            "PLAYER is random, depth:D or depth:D:MATERIAL,MOBILITY,THREATS,CENTRE,BACKROW\n";
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        string value = argv[++i];
+        bool ok = true;
+        if (arg == "--games")
+            options.games = atol(value.c_str());
+        else if (arg == "--threads")
+            options.threads = atoi(value.c_str());
+        else if (arg == "--a")
+            ok = parsePlayer(value, options.a);
+        else if (arg == "--b")
+            ok = parsePlayer(value, options.b);
+        else if (arg == "--openings")
+            options.openings = atoi(value.c_str());
+        else if (arg == "--max-plies")
+            options.maxPlies = atoi(value.c_str());
+        else if (arg == "--hash")
+            options.hashMB = atol(value.c_str());
+        else if (arg == "--seed")
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--out")
+            options.out = value;
+        else
+            ok = false;
+        if (!ok)
+        {
+            cerr << "bad argument: " << arg << " " << value << "\n";
+            usage();
+            return 1;
+        }
+    }
+
+    Totals totals;
+    auto start = chrono::steady_clock::now();
+    {
+        bead::ThreadPool pool(options.threads);
+        vector<WorkerState> workers(pool.size());
+        cerr << "Playing " << options.games << " games on " << pool.size() << " threads" << endl;
+
+        for (long g = 0; g < options.games; g++)
+        {
+            pool.submit([&options, &totals, &workers, g](int worker) {
+                WorkerState &state = workers[worker];
+                const PlayerSpec *specs[2] = {&options.a, &options.b};
+                Searcher *searchers[2] = {nullptr, nullptr};
+                for (int p = 0; p < 2; p++)
+                {
+                    if (specs[p]->depth == 0)
+                        continue;
+                    if (!state.searchers[p])
+                    {
+                        state.searchers[p].reset(new Searcher(options.hashMB));
+                        state.searchers[p]->setEvalWeights(specs[p]->weights);
+                    }
+                    // A fresh table per game keeps results independent of scheduling
+                    state.searchers[p]->clearHistory();
+                    searchers[p] = state.searchers[p].get();
+                }
+
+                // Both games of a pair share the opening; A moves first in the even one
+                bool aFirst = g % 2 == 0;
+                const PlayerSpec *players[2] = {specs[aFirst ? 0 : 1], specs[aFirst ? 1 : 0]};
+                Searcher *bySide[2] = {searchers[aFirst ? 0 : 1], searchers[aFirst ? 1 : 0]};
+                uint64_t seed = options.seed * 0x9E3779B97F4A7C15ull + uint64_t(g / 2);
+
+                long plies = 0;
+                int winner = playGame(options, players, bySide, seed, plies);
+                totals.plies += plies;
+                int aSide = aFirst ? 1 : 2;
+                if (winner == 0)
+                    totals.draws++;
+                else if (winner == aSide)
+                    totals.wins++;
+                else
+                    totals.losses++;
+                if (aFirst)
+                {
+                    totals.gamesAsFirst++;
+                    if (winner == aSide)
+                        totals.winsAsFirst++;
+                }
+            });
+        }
+        pool.wait();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    string text = report(options, totals, seconds);
+    cout << text;
+    if (!options.out.empty())
+    {
+        ofstream file(options.out);
+        if (!file)
+        {
+            cerr << "Error writing " << options.out << endl;
+            return 1;
+        }
+        file << text;
+    }
+    return 0;
+}